@@ -0,0 +1,85 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+namespace
+{
+	atomic<uint64_t> allocationCount(0);
+	atomic<uint64_t> allocationBytes(0);
+
+	void* allocate(size_t size)
+	{
+		allocationCount.fetch_add(1, memory_order_relaxed);
+		allocationBytes.fetch_add(size, memory_order_relaxed);
+		return malloc(size == 0 ? 1 : size);
+	}
+}
+
+uint64_t AllocationCounter::allocations()
+{
+	return allocationCount.load(memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::bytes()
+{
+	return allocationBytes.load(memory_order_relaxed);
+}
+
+void* operator new(size_t size)
+{
+	void* pointer = allocate(size);
+	if (pointer == nullptr)
+	{
+		throw bad_alloc();
+	}
+	return pointer;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void* pointer, const nothrow_t&) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer, const nothrow_t&) noexcept
+{
+	free(pointer);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+class AllocationCounter
+{
+public:
+	static uint64_t allocations();
+	static uint64_t bytes();
+};
@@ -0,0 +1,556 @@
+#include "arena.h"
+#include "profiler.h"
+
+#define BISECTION_STEPS 12
+#define MIN_BUCKETS 64
+#define BUCKET_RESERVE 4
+#define PENETRATION_TOLERANCE 1e-3f
+
+using namespace std;
+using namespace cv;
+
+Arena::Arena(const float cellSize) :
+	m_stamp(0),
+	m_cellSize(cellSize > 0.0f ? cellSize : 1.0f),
+	m_autoCellSize(cellSize <= 0.0f)
+{
+	rehash(MIN_BUCKETS);
+}
+
+size_t Arena::add(Robot& robot)
+{
+	size_t index = m_robots.size();
+
+	m_robots.push_back(&robot);
+	m_warRobots.push_back(dynamic_cast<WarRobot*>(&robot));
+	m_bounds.push_back(bounds(robot.footprint()));
+	m_visited.push_back(0);
+	m_candidates.reserve(m_robots.size());
+
+	auto& border = m_bounds.back();
+	float extent = max(border.right - border.left, border.top - border.bottom);
+	if (m_autoCellSize == true && extent > m_cellSize)
+	{
+		m_cellSize = extent;
+		rehash(m_buckets.size());
+	}
+	else if (m_robots.size() * 2 > m_buckets.size())
+	{
+		rehash(m_buckets.size() * 2);
+	}
+	else
+	{
+		insert(index);
+	}
+
+	return index;
+}
+
+void Arena::clear()
+{
+	m_robots.clear();
+	m_warRobots.clear();
+	m_bounds.clear();
+	m_visited.clear();
+	rehash(MIN_BUCKETS);
+}
+
+size_t Arena::size() const
+{
+	return m_robots.size();
+}
+
+Robot& Arena::robot(size_t index)
+{
+	return *m_robots.at(index);
+}
+
+float Arena::cellSize() const
+{
+	return m_cellSize;
+}
+
+void Arena::update()
+{
+	for (size_t index = 0; index < m_robots.size(); index++)
+	{
+		m_bounds[index] = bounds(m_robots[index]->footprint());
+	}
+	rehash(m_buckets.size());
+}
+
+int32_t Arena::move(size_t index, Direction direction)
+{
+	PROFILE_SCOPE_ID("Arena::move", index);
+
+	Robot& robot = *m_robots.at(index);
+	auto start = robot.center();
+	int32_t result = robot.move(direction);
+	auto finish = robot.center();
+
+	return resolve(index, result, [&robot, start, finish](const float fraction)
+	{
+		robot.setCenter(start.x + (finish.x - start.x) * fraction, start.y + (finish.y - start.y) * fraction);
+	}, false);
+}
+
+int32_t Arena::rotate(size_t index, Rotation rotation)
+{
+	PROFILE_SCOPE_ID("Arena::rotate", index);
+
+	Robot& robot = *m_robots.at(index);
+	float start = robot.angle();
+	int32_t result = robot.rotate(rotation);
+	float finish = robot.angle();
+
+	return resolve(index, result, [&robot, start, finish](const float fraction)
+	{
+		robot.setAngle(start + (finish - start) * fraction);
+	}, true);
+}
+
+int32_t Arena::go(size_t index, Direction direction, Rotation rotation)
+{
+	PROFILE_SCOPE_ID("Arena::go", index);
+
+	Robot& robot = *m_robots.at(index);
+	auto start = robot.center();
+	float startAngle = robot.angle();
+	int32_t result = robot.go(direction, rotation);
+	auto finish = robot.center();
+	float finishAngle = robot.angle();
+
+	return resolve(index, result, [&robot, start, finish, startAngle, finishAngle](const float fraction)
+	{
+		robot.setCenter(start.x + (finish.x - start.x) * fraction, start.y + (finish.y - start.y) * fraction);
+		robot.setAngle(startAngle + (finishAngle - startAngle) * fraction);
+	}, true);
+}
+
+int32_t Arena::rotateTurret(size_t index, Rotation rotation)
+{
+	WarRobot* robot = m_warRobots.at(index);
+	if (robot == nullptr)
+	{
+		return -1;
+	}
+
+	robot->mountCombatModule();
+	float start = robot->combatModule().angle();
+	int32_t result = robot->combatModule().rotate(rotation);
+	float finish = robot->combatModule().angle();
+
+	return resolve(index, result, [robot, start, finish](const float fraction)
+	{
+		robot->combatModule().setAngle(start + (finish - start) * fraction);
+	}, true);
+}
+
+void Arena::doSomething(size_t index, const char key)
+{
+	switch (key)
+	{
+	case 'w':
+	case 'W':
+		move(index, Direction::FORWARD);
+		break;
+	case 's':
+	case 'S':
+		move(index, Direction::BACK);
+		break;
+	case 'a':
+	case 'A':
+		move(index, Direction::LEFT);
+		break;
+	case 'd':
+	case 'D':
+		move(index, Direction::RIGHT);
+		break;
+	case 'q':
+	case 'Q':
+		go(index, Direction::FORWARD, Rotation::COUNTER_CLOCKWISE);
+		break;
+	case 'e':
+	case 'E':
+		go(index, Direction::FORWARD, Rotation::CLOCKWISE);
+		break;
+	case 'z':
+	case 'Z':
+		go(index, Direction::BACK, Rotation::CLOCKWISE);
+		break;
+	case 'x':
+	case 'X':
+		go(index, Direction::BACK, Rotation::COUNTER_CLOCKWISE);
+		break;
+	case '.':
+	case '>':
+		rotate(index, Rotation::CLOCKWISE);
+		break;
+	case ',':
+	case '<':
+		rotate(index, Rotation::COUNTER_CLOCKWISE);
+		break;
+	case ']':
+	case '}':
+		rotateTurret(index, Rotation::CLOCKWISE);
+		break;
+	case '[':
+	case '{':
+		rotateTurret(index, Rotation::COUNTER_CLOCKWISE);
+		break;
+	default:
+		break;
+	}
+}
+
+bool Arena::collides(size_t index)
+{
+	gatherCandidates(index, bounds(m_robots.at(index)->footprint()));
+	return collidesWithCandidates(index);
+}
+
+bool Arena::overlaps(const Footprint& first, const Footprint& second)
+{
+	for (size_t i = 0; i < first.size; i++)
+	{
+		for (size_t j = 0; j < second.size; j++)
+		{
+			if (overlaps(first.parts[i], second.parts[j]) == true)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool Arena::overlaps(const PolygonPoints& first, const PolygonPoints& second)
+{
+	auto separated = [](const PolygonPoints& edges, const PolygonPoints& first, const PolygonPoints& second)
+	{
+		for (size_t index = 0; index < edges.size(); index++)
+		{
+			auto& from = edges[index];
+			auto& to = edges[(index + 1) % edges.size()];
+			auto normal = Point2f(from.y - to.y, to.x - from.x);
+
+			float firstMin = FLT_MAX;
+			float firstMax = -FLT_MAX;
+			for (auto& point : first)
+			{
+				float projection = normal.x * point.x + normal.y * point.y;
+				firstMin = min(firstMin, projection);
+				firstMax = max(firstMax, projection);
+			}
+
+			float secondMin = FLT_MAX;
+			float secondMax = -FLT_MAX;
+			for (auto& point : second)
+			{
+				float projection = normal.x * point.x + normal.y * point.y;
+				secondMin = min(secondMin, projection);
+				secondMax = max(secondMax, projection);
+			}
+
+			if (firstMax <= secondMin || secondMax <= firstMin)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	if (first.empty() == true || second.empty() == true)
+	{
+		return false;
+	}
+
+	return separated(first, first, second) == false && separated(second, first, second) == false;
+}
+
+float Arena::penetration(const PolygonPoints& first, const PolygonPoints& second)
+{
+	// The smallest overlap of the projections over every edge normal of both
+	// polygons, zero once any of them separates.
+	auto depth = [](const PolygonPoints& edges, const PolygonPoints& first, const PolygonPoints& second)
+	{
+		float depth = FLT_MAX;
+
+		for (size_t index = 0; index < edges.size(); index++)
+		{
+			auto& from = edges[index];
+			auto& to = edges[(index + 1) % edges.size()];
+			auto normal = Point2f(from.y - to.y, to.x - from.x);
+			float length = hypotf(normal.x, normal.y);
+			if (length == 0.0f)
+			{
+				continue;
+			}
+			normal = normal * (1.0f / length);
+
+			float firstMin = FLT_MAX;
+			float firstMax = -FLT_MAX;
+			for (auto& point : first)
+			{
+				float projection = normal.x * point.x + normal.y * point.y;
+				firstMin = min(firstMin, projection);
+				firstMax = max(firstMax, projection);
+			}
+
+			float secondMin = FLT_MAX;
+			float secondMax = -FLT_MAX;
+			for (auto& point : second)
+			{
+				float projection = normal.x * point.x + normal.y * point.y;
+				secondMin = min(secondMin, projection);
+				secondMax = max(secondMax, projection);
+			}
+
+			depth = min(depth, min(firstMax - secondMin, secondMax - firstMin));
+		}
+
+		return depth;
+	};
+
+	if (first.empty() == true || second.empty() == true)
+	{
+		return 0.0f;
+	}
+
+	return max(min(depth(first, first, second), depth(second, first, second)), 0.0f);
+}
+
+template <typename Pose>
+int32_t Arena::resolve(size_t index, int32_t result, Pose pose, const bool rotating)
+{
+	Robot& robot = *m_robots[index];
+	Border finish = bounds(robot.footprint());
+
+	gatherCandidates(index, sweptBounds(index, m_bounds[index], finish, rotating));
+
+	if (m_candidates.empty() == true || collidesWithCandidates(index) == false)
+	{
+		erase(index);
+		m_bounds[index] = finish;
+		insert(index);
+		return result;
+	}
+
+	// A robot that already overlaps may only move in ways that do not push
+	// it deeper; anything else keeps the start pose.
+	pose(0.0f);
+	if (collidesWithCandidates(index) == true)
+	{
+		float depth = penetrationWithCandidates(index);
+		pose(1.0f);
+		if (penetrationWithCandidates(index) > depth + PENETRATION_TOLERANCE)
+		{
+			pose(0.0f);
+			result = -2;
+		}
+
+		erase(index);
+		m_bounds[index] = bounds(robot.footprint());
+		insert(index);
+		return result;
+	}
+
+	float safe = 0.0f;
+	float blocked = 1.0f;
+	for (int32_t step = 0; step < BISECTION_STEPS; step++)
+	{
+		float fraction = (safe + blocked) / 2.0f;
+		pose(fraction);
+		if (collidesWithCandidates(index) == true)
+		{
+			blocked = fraction;
+		}
+		else
+		{
+			safe = fraction;
+		}
+	}
+
+	pose(safe);
+	erase(index);
+	m_bounds[index] = bounds(robot.footprint());
+	insert(index);
+
+	return -2;
+}
+
+Border Arena::bounds(const Footprint& footprint) const
+{
+	Border border = { -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX };
+
+	for (size_t part = 0; part < footprint.size; part++)
+	{
+		for (auto& point : footprint.parts[part])
+		{
+			border.right = max(border.right, point.x);
+			border.top = max(border.top, point.y);
+			border.left = min(border.left, point.x);
+			border.bottom = min(border.bottom, point.y);
+		}
+	}
+
+	return border;
+}
+
+Border Arena::sweptBounds(size_t index, const Border& start, const Border& finish, const bool rotating)
+{
+	Border swept =
+	{
+		max(finish.right, start.right),
+		max(finish.top, start.top),
+		min(finish.left, start.left),
+		min(finish.bottom, start.bottom)
+	};
+
+	if (rotating == false)
+	{
+		return swept;
+	}
+
+	auto center = m_robots[index]->center();
+	float radius = 0.0f;
+	for (auto& border : { start, finish })
+	{
+		radius = max(radius, hypotf(max(border.right - center.x, center.x - border.left),
+		                            max(border.top - center.y, center.y - border.bottom)));
+	}
+
+	radius += m_robots[index]->speed();
+
+	swept.right = max(swept.right, center.x + radius);
+	swept.top = max(swept.top, center.y + radius);
+	swept.left = min(swept.left, center.x - radius);
+	swept.bottom = min(swept.bottom, center.y - radius);
+
+	return swept;
+}
+
+void Arena::insert(size_t index)
+{
+	auto& border = m_bounds[index];
+
+	for (int32_t cellX = cvFloor(border.left / m_cellSize); cellX <= cvFloor(border.right / m_cellSize); cellX++)
+	{
+		for (int32_t cellY = cvFloor(border.bottom / m_cellSize); cellY <= cvFloor(border.top / m_cellSize); cellY++)
+		{
+			auto& cell = m_buckets[bucket(cellX, cellY)];
+			if (find(cell.begin(), cell.end(), static_cast<uint32_t>(index)) == cell.end())
+			{
+				cell.push_back(static_cast<uint32_t>(index));
+			}
+		}
+	}
+}
+
+void Arena::erase(size_t index)
+{
+	auto& border = m_bounds[index];
+
+	for (int32_t cellX = cvFloor(border.left / m_cellSize); cellX <= cvFloor(border.right / m_cellSize); cellX++)
+	{
+		for (int32_t cellY = cvFloor(border.bottom / m_cellSize); cellY <= cvFloor(border.top / m_cellSize); cellY++)
+		{
+			auto& cell = m_buckets[bucket(cellX, cellY)];
+			auto position = find(cell.begin(), cell.end(), static_cast<uint32_t>(index));
+			if (position != cell.end())
+			{
+				*position = cell.back();
+				cell.pop_back();
+			}
+		}
+	}
+}
+
+void Arena::rehash(size_t bucketCount)
+{
+	// Cells keep their capacity across rehashes and start with room for a few
+	// robots, so robots moving between cells do not allocate.
+	m_buckets.resize(max(bucketCount, static_cast<size_t>(MIN_BUCKETS)));
+	for (auto& cell : m_buckets)
+	{
+		cell.clear();
+		cell.reserve(min(m_robots.size(), static_cast<size_t>(BUCKET_RESERVE)));
+	}
+
+	for (size_t index = 0; index < m_robots.size(); index++)
+	{
+		insert(index);
+	}
+}
+
+size_t Arena::bucket(int32_t cellX, int32_t cellY) const
+{
+	uint32_t hash = static_cast<uint32_t>(cellX) * 73856093u ^ static_cast<uint32_t>(cellY) * 19349663u;
+	return hash & (m_buckets.size() - 1);
+}
+
+void Arena::gatherCandidates(size_t index, const Border& bounds)
+{
+	m_candidates.clear();
+	m_stamp++;
+	m_visited[index] = m_stamp;
+
+	for (int32_t cellX = cvFloor(bounds.left / m_cellSize); cellX <= cvFloor(bounds.right / m_cellSize); cellX++)
+	{
+		for (int32_t cellY = cvFloor(bounds.bottom / m_cellSize); cellY <= cvFloor(bounds.top / m_cellSize); cellY++)
+		{
+			for (auto other : m_buckets[bucket(cellX, cellY)])
+			{
+				if (m_visited[other] == m_stamp)
+				{
+					continue;
+				}
+				m_visited[other] = m_stamp;
+
+				auto& border = m_bounds[other];
+				if (border.left < bounds.right && bounds.left < border.right &&
+					border.bottom < bounds.top && bounds.bottom < border.top)
+				{
+					m_candidates.push_back(other);
+				}
+			}
+		}
+	}
+}
+
+bool Arena::collidesWithCandidates(size_t index)
+{
+	auto footprint = m_robots[index]->footprint();
+
+	for (auto other : m_candidates)
+	{
+		if (overlaps(footprint, m_robots[other]->footprint()) == true)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+float Arena::penetrationWithCandidates(size_t index)
+{
+	auto footprint = m_robots[index]->footprint();
+	float depth = 0.0f;
+
+	for (auto other : m_candidates)
+	{
+		auto otherFootprint = m_robots[other]->footprint();
+		for (size_t i = 0; i < footprint.size; i++)
+		{
+			for (size_t j = 0; j < otherFootprint.size; j++)
+			{
+				depth += penetration(footprint.parts[i], otherFootprint.parts[j]);
+			}
+		}
+	}
+
+	return depth;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+#include "war_robot.h"
+
+class Arena
+{
+public:
+	Arena(const float cellSize = 0.0f);
+	~Arena() = default;
+
+	size_t add(Robot& robot);
+	void clear();
+	size_t size() const;
+	Robot& robot(size_t index);
+
+	float cellSize() const;
+	void update();
+
+	int32_t move(size_t index, Direction direction);
+	int32_t rotate(size_t index, Rotation rotation);
+	int32_t go(size_t index, Direction direction, Rotation rotation);
+	int32_t rotateTurret(size_t index, Rotation rotation);
+
+	void doSomething(size_t index, const char key);
+
+	bool collides(size_t index);
+	static bool overlaps(const Footprint& first, const Footprint& second);
+	static bool overlaps(const PolygonPoints& first, const PolygonPoints& second);
+	static float penetration(const PolygonPoints& first, const PolygonPoints& second);
+
+private:
+	template <typename Pose>
+	int32_t resolve(size_t index, int32_t result, Pose pose, const bool rotating);
+
+	Border bounds(const Footprint& footprint) const;
+	Border sweptBounds(size_t index, const Border& start, const Border& finish, const bool rotating);
+	void insert(size_t index);
+	void erase(size_t index);
+	void rehash(size_t bucketCount);
+	size_t bucket(int32_t cellX, int32_t cellY) const;
+	void gatherCandidates(size_t index, const Border& bounds);
+	bool collidesWithCandidates(size_t index);
+	float penetrationWithCandidates(size_t index);
+
+	std::vector<Robot*> m_robots;
+	std::vector<WarRobot*> m_warRobots;
+	std::vector<Border> m_bounds;
+	std::vector<std::vector<uint32_t>> m_buckets;
+	std::vector<uint32_t> m_candidates;
+	std::vector<uint32_t> m_visited;
+	uint32_t m_stamp;
+	float m_cellSize;
+	bool m_autoCellSize;
+};
@@ -0,0 +1,352 @@
+#include "arena_executor.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+using namespace std;
+using namespace cv;
+
+ArenaWorld::ArenaWorld(const Border border) :
+	m_border(border),
+	m_controller(nullptr),
+	m_observer(nullptr),
+	m_ticks(0)
+{
+
+}
+
+size_t ArenaWorld::add(const WarRobot& robot)
+{
+	m_robots.push_back(robot);
+	m_robots.back().setBorder(m_border);
+	m_robots.back().mountCombatModule();
+
+	return m_arena.add(m_robots.back());
+}
+
+size_t ArenaWorld::size() const
+{
+	return m_robots.size();
+}
+
+WarRobot& ArenaWorld::robot(size_t index)
+{
+	return m_robots.at(index);
+}
+
+Arena& ArenaWorld::arena()
+{
+	return m_arena;
+}
+
+Border ArenaWorld::border() const
+{
+	return m_border;
+}
+
+void ArenaWorld::setController(Controller controller)
+{
+	m_controller = controller;
+}
+
+void ArenaWorld::setObserver(Observer observer)
+{
+	m_observer = observer;
+}
+
+void ArenaWorld::step()
+{
+	if (m_controller != nullptr)
+	{
+		for (size_t index = 0; index < m_robots.size(); index++)
+		{
+			char key = m_controller(*this, index);
+			if (key != 0)
+			{
+				m_arena.doSomething(index, key);
+			}
+		}
+	}
+
+	m_ticks++;
+
+	if (m_observer != nullptr)
+	{
+		m_observer(*this);
+	}
+}
+
+uint64_t ArenaWorld::ticks() const
+{
+	return m_ticks;
+}
+
+ArenaExecutor::ArenaExecutor(const uint32_t threads) :
+	m_generation(0),
+	m_stop(false),
+	m_pending(0),
+	m_failed(false),
+	m_ticks(0),
+	m_runs(0),
+	m_worldTicks(0),
+	m_seconds(0.0)
+{
+	uint32_t count = threads > 0 ? threads : max(thread::hardware_concurrency(), 1u);
+
+	for (uint32_t index = 0; index < count; index++)
+	{
+		m_workers.push_back(unique_ptr<Worker>(new Worker()));
+		m_workers.back()->executed.store(0);
+		m_workers.back()->steals.store(0);
+		m_workers.back()->busy.store(0);
+		m_workers.back()->head = 0;
+		m_workers.back()->tail = 0;
+		m_workers.back()->seed = index * 2654435761u + 1u;
+	}
+
+	for (uint32_t index = 1; index < count; index++)
+	{
+		m_threads.push_back(thread(&ArenaExecutor::work, this, index));
+	}
+}
+
+ArenaExecutor::~ArenaExecutor()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+
+	for (auto& worker : m_threads)
+	{
+		worker.join();
+	}
+}
+
+size_t ArenaExecutor::add(std::unique_ptr<ArenaWorld> world)
+{
+	m_costs.push_back(static_cast<int64_t>(world->size()) + 1);
+	m_worlds.push_back(std::move(world));
+
+	return m_worlds.size() - 1;
+}
+
+void ArenaExecutor::clear()
+{
+	m_worlds.clear();
+	m_costs.clear();
+}
+
+size_t ArenaExecutor::size() const
+{
+	return m_worlds.size();
+}
+
+ArenaWorld& ArenaExecutor::world(size_t index)
+{
+	return *m_worlds.at(index);
+}
+
+uint32_t ArenaExecutor::threads() const
+{
+	return static_cast<uint32_t>(m_workers.size());
+}
+
+int32_t ArenaExecutor::run(const uint64_t ticks)
+{
+	if (m_worlds.size() > UINT32_MAX)
+	{
+		return -1;
+	}
+
+	if (ticks == 0 || m_worlds.empty() == true)
+	{
+		return 0;
+	}
+
+	PROFILE_SCOPE("ArenaExecutor::run");
+
+	auto start = chrono::steady_clock::now();
+
+	auto& order = m_order;
+	order.resize(m_worlds.size());
+	iota(order.begin(), order.end(), 0u);
+	sort(order.begin(), order.end(), [this](uint32_t first, uint32_t second)
+	{
+		return m_costs[first] > m_costs[second] || (m_costs[first] == m_costs[second] && first < second);
+	});
+
+	m_ticks = ticks;
+	m_pending.store(m_worlds.size());
+	m_failed.store(false);
+
+	// Dealt round-robin from the most expensive, so every queue ends up with
+	// its largest world at the back where the owner pops first.
+	size_t count = m_workers.size();
+	for (size_t index = 0; index < count; index++)
+	{
+		auto& worker = *m_workers[index];
+		lock_guard<mutex> lock(worker.mutex);
+
+		size_t size = (order.size() + count - 1 - index) / count;
+		if (worker.tasks.size() < size)
+		{
+			worker.tasks.resize(size);
+		}
+
+		for (size_t slot = 0; slot < size; slot++)
+		{
+			worker.tasks[size - 1 - slot] = order[index + slot * count];
+		}
+		worker.head = 0;
+		worker.tail = size;
+	}
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_generation++;
+	}
+	m_wake.notify_all();
+
+	drain(0);
+
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_done.wait(lock, [this]() { return m_pending.load() == 0; });
+	}
+
+	m_runs++;
+	m_worldTicks += ticks * m_worlds.size();
+	m_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	return m_failed.load() == true ? -2 : 0;
+}
+
+ExecutorStatistics ArenaExecutor::statistics() const
+{
+	ExecutorStatistics statistics = { m_runs, 0, 0, m_worldTicks, m_seconds, 0.0 };
+
+	for (auto& worker : m_workers)
+	{
+		statistics.tasks += worker->executed.load(memory_order_relaxed);
+		statistics.steals += worker->steals.load(memory_order_relaxed);
+		statistics.busySeconds += worker->busy.load(memory_order_relaxed) * 1e-9;
+	}
+
+	return statistics;
+}
+
+void ArenaExecutor::work(const uint32_t index)
+{
+	uint64_t generation = 0;
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_wake.wait(lock, [this, generation]() { return m_stop == true || m_generation != generation; });
+			if (m_stop == true)
+			{
+				return;
+			}
+			generation = m_generation;
+		}
+
+		drain(index);
+	}
+}
+
+void ArenaExecutor::drain(const uint32_t index)
+{
+	// Tasks are only dealt by run(), so once a steal finds every queue empty
+	// there is nothing left to take and the worker parks until the next run.
+	uint32_t task;
+	while (pop(index, task) == true || steal(index, task) == true)
+	{
+		execute(index, task);
+	}
+}
+
+bool ArenaExecutor::pop(const uint32_t index, uint32_t& task)
+{
+	auto& worker = *m_workers[index];
+	lock_guard<mutex> lock(worker.mutex);
+
+	if (worker.head == worker.tail)
+	{
+		return false;
+	}
+
+	task = worker.tasks[--worker.tail];
+
+	return true;
+}
+
+bool ArenaExecutor::steal(const uint32_t index, uint32_t& task)
+{
+	auto& thief = *m_workers[index];
+	size_t count = m_workers.size();
+
+	thief.seed = thief.seed * 1664525u + 1013904223u;
+	size_t first = (thief.seed >> 8) % count;
+
+	for (size_t offset = 0; offset < count; offset++)
+	{
+		size_t victim = (first + offset) % count;
+		if (victim == index)
+		{
+			continue;
+		}
+
+		auto& worker = *m_workers[victim];
+		lock_guard<mutex> lock(worker.mutex);
+
+		if (worker.head != worker.tail)
+		{
+			task = worker.tasks[worker.head++];
+			thief.steals.fetch_add(1, memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ArenaExecutor::execute(const uint32_t index, const uint32_t task)
+{
+	auto& worker = *m_workers[index];
+	auto& world = *m_worlds[task];
+	auto start = chrono::steady_clock::now();
+
+	{
+		PROFILE_SCOPE_ID("ArenaExecutor::task", task);
+
+		// A throwing controller or observer must not take its worker thread
+		// down or leave run() waiting; the world stops for this run instead.
+		try
+		{
+			for (uint64_t tick = 0; tick < m_ticks; tick++)
+			{
+				world.step();
+			}
+		}
+		catch (...)
+		{
+			m_failed.store(true);
+		}
+	}
+
+	int64_t cost = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+	m_costs[task] = max<int64_t>(cost, 1);
+	worker.busy.fetch_add(cost, memory_order_relaxed);
+	worker.executed.fetch_add(1, memory_order_relaxed);
+
+	if (m_pending.fetch_sub(1) == 1)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_done.notify_all();
+	}
+}
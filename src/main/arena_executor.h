@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "arena.h"
+
+// One independent world: robots owned by value behind stable addresses, a
+// single Border and an Arena over them. A step asks the controller for one
+// key per robot and applies it through the Arena, so robots of one world
+// never touch another world; the observer then sees the world after the step.
+class ArenaWorld
+{
+public:
+	typedef std::function<char(ArenaWorld& world, size_t index)> Controller;
+	typedef std::function<void(ArenaWorld& world)> Observer;
+
+	ArenaWorld(const Border border);
+	~ArenaWorld() = default;
+
+	ArenaWorld(const ArenaWorld&) = delete;
+	ArenaWorld& operator=(const ArenaWorld&) = delete;
+
+	size_t add(const WarRobot& robot);
+	size_t size() const;
+	WarRobot& robot(size_t index);
+	Arena& arena();
+	Border border() const;
+
+	void setController(Controller controller);
+	void setObserver(Observer observer);
+	void step();
+	uint64_t ticks() const;
+
+private:
+	Border m_border;
+	std::deque<WarRobot> m_robots;
+	Arena m_arena;
+	Controller m_controller;
+	Observer m_observer;
+	uint64_t m_ticks;
+};
+
+struct ExecutorStatistics
+{
+	uint64_t runs;
+	uint64_t tasks;
+	uint64_t steals;
+	uint64_t worldTicks;
+	double seconds;
+	double busySeconds;
+};
+
+// Steps many independent worlds on a fixed pool of workers. Every worker owns
+// a queue of world tasks: it pops the most expensive one from the back and an
+// idle worker steals from the front of a random victim, so a crowded world
+// keeps one worker busy while the rest drain the others. Tasks are dealt out
+// by the time each world took on the previous run, the robot count before
+// that. The calling thread is worker 0 and takes part in run(); workers that
+// find every queue empty park instead of spinning. run() returns -2 when a
+// world threw, after the other worlds have finished their ticks.
+class ArenaExecutor
+{
+public:
+	ArenaExecutor(const uint32_t threads = 0);
+	~ArenaExecutor();
+
+	ArenaExecutor(const ArenaExecutor&) = delete;
+	ArenaExecutor& operator=(const ArenaExecutor&) = delete;
+
+	size_t add(std::unique_ptr<ArenaWorld> world);
+	void clear();
+	size_t size() const;
+	ArenaWorld& world(size_t index);
+	uint32_t threads() const;
+
+	int32_t run(const uint64_t ticks);
+	ExecutorStatistics statistics() const;
+
+private:
+	struct Worker
+	{
+		std::mutex mutex;
+		std::vector<uint32_t> tasks;
+		size_t head;
+		size_t tail;
+		std::atomic<uint64_t> executed;
+		std::atomic<uint64_t> steals;
+		std::atomic<int64_t> busy;
+		uint32_t seed;
+	};
+
+	void work(const uint32_t index);
+	void drain(const uint32_t index);
+	bool pop(const uint32_t index, uint32_t& task);
+	bool steal(const uint32_t index, uint32_t& task);
+	void execute(const uint32_t index, const uint32_t task);
+
+	std::vector<std::unique_ptr<ArenaWorld>> m_worlds;
+	std::vector<int64_t> m_costs;
+	std::vector<uint32_t> m_order;
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	uint64_t m_generation;
+	bool m_stop;
+	std::atomic<size_t> m_pending;
+	std::atomic<bool> m_failed;
+	uint64_t m_ticks;
+	uint64_t m_runs;
+	uint64_t m_worldTicks;
+	double m_seconds;
+};
@@ -0,0 +1,42 @@
+#include "benchmark.h"
+#include "arena_executor.h"
+
+#include <set>
+
+using namespace std;
+using namespace cv;
+
+void benchmarkArenaExecutor(Benchmark& benchmark)
+{
+	auto& robots = benchmark.robots();
+
+	// Uneven worlds: mostly one to four robots, every 32nd one crowded.
+	set<uint32_t> threadCounts = { 1, 2, 4, max(thread::hardware_concurrency(), 1u) };
+	for (auto threads : threadCounts)
+	{
+		ArenaExecutor executor(threads);
+		size_t next = 0;
+		for (uint32_t index = 0; index < 256; index++)
+		{
+			unique_ptr<ArenaWorld> world(new ArenaWorld(robots.front().border()));
+			size_t count = index % 32 == 0 ? 24 : 1 + index % 4;
+			for (size_t robot = 0; robot < count; robot++)
+			{
+				world->add(robots[next++ % robots.size()]);
+			}
+			world->setController([](ArenaWorld& world, size_t robot)
+			{
+				const char keys[] = "wasdqezx.,[]";
+				uint32_t hash = static_cast<uint32_t>(world.ticks() / 8 * 2654435761u + robot * 40503u);
+				return keys[(hash >> 8) % (sizeof(keys) - 1)];
+			});
+			executor.add(move(world));
+		}
+
+		benchmark.measure("ArenaExecutor::run/threads=" + to_string(threads), 1, [&executor](size_t)
+		{
+			executor.run(4);
+			return static_cast<float>(executor.statistics().steals);
+		}, executor.size() * 4);
+	}
+}
@@ -0,0 +1,251 @@
+#include "benchmark.h"
+#include "fast_math.h"
+#include "robot_fleet.h"
+
+#include <iomanip>
+#include <random>
+
+using namespace std;
+using namespace cv;
+
+namespace
+{
+	const char* placementName(Placement placement)
+	{
+		switch (placement)
+		{
+		case Placement::NEAR_BORDER:
+			return "near_border";
+		case Placement::AWAY_FROM_BORDER:
+			return "away_from_border";
+		default:
+			return "unknown";
+		}
+	}
+}
+
+Benchmark::Benchmark(
+	const uint32_t poses,
+	const double minimumSeconds,
+	const uint32_t seed
+) :
+	m_poses(poses),
+	m_minimumSeconds(minimumSeconds),
+	m_seed(seed),
+	m_area(1080, 720),
+	m_sink(0.0f),
+	m_placement(Placement::NEAR_BORDER)
+{
+
+}
+
+vector<WarRobot> Benchmark::makeRobots(Placement placement)
+{
+	mt19937 random(m_seed + static_cast<uint32_t>(placement));
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	vector<WarRobot> robots;
+	robots.reserve(m_poses);
+
+	for (uint32_t index = 0; index < m_poses; index++)
+	{
+		float angle = static_cast<float>(2.0 * M_PI) * unit(random);
+		auto robot = WarRobot(60, 120, { 10, 40 }, CombatModule(), Point2f(0, 0), angle);
+		robot.setSpeed(SPEED);
+		robot.setAngularSpeed(ANGULAR_SPEED);
+		robot.combatModule().setAngularSpeed(0.2f);
+		robot.combatModule().setAngle(static_cast<float>(2.0 * M_PI) * unit(random));
+
+		float gunReach = 1.5f * robot.combatModule().length();
+		float radius = max(hypotf(robot.length() / 2.0f, (robot.width() + 3.0f * robot.wheel().width) / 2.0f), gunReach);
+		float width = static_cast<float>(m_area.width) - 1.0f;
+		float height = static_cast<float>(m_area.height) - 1.0f;
+
+		float x;
+		float y;
+		if (placement == Placement::NEAR_BORDER)
+		{
+			float gap = radius + 2.0f * SPEED * unit(random);
+			float along = unit(random);
+			switch (random() % 4)
+			{
+			case 0:
+				x = gap;
+				y = radius + along * (height - 2.0f * radius);
+				break;
+			case 1:
+				x = width - gap;
+				y = radius + along * (height - 2.0f * radius);
+				break;
+			case 2:
+				x = radius + along * (width - 2.0f * radius);
+				y = gap;
+				break;
+			default:
+				x = radius + along * (width - 2.0f * radius);
+				y = height - gap;
+				break;
+			}
+		}
+		else
+		{
+			float margin = radius + 4.0f * SPEED;
+			x = margin + unit(random) * (width - 2.0f * margin);
+			y = margin + unit(random) * (height - 2.0f * margin);
+		}
+
+		robot.setCenter(x, y);
+		robot.mountCombatModule();
+		robots.push_back(robot);
+	}
+
+	return robots;
+}
+
+vector<BenchmarkResult> Benchmark::run()
+{
+	const Registration registrations[] =
+	{
+		benchmarkRobot,
+		benchmarkFastMath,
+		benchmarkRobotGeometry,
+		benchmarkRenderer,
+		benchmarkPlanner,
+		benchmarkProjectilePool,
+		benchmarkTurretSolver,
+		benchmarkEventIntegrator,
+		benchmarkArenaExecutor,
+		benchmarkVectorEnv,
+		benchmarkLidar,
+		benchmarkObstacleMap,
+		benchmarkRobotFleet
+	};
+
+	m_results.clear();
+
+	for (auto placement : { Placement::NEAR_BORDER, Placement::AWAY_FROM_BORDER })
+	{
+		m_placement = placement;
+		m_robots = makeRobots(placement);
+		m_image = Mat(m_area, CV_8UC3, Scalar(0xFF, 0xFF, 0xFF));
+
+		for (auto registration : registrations)
+		{
+			registration(*this);
+		}
+	}
+
+	m_robots.clear();
+
+	return m_results;
+}
+
+int32_t Benchmark::checkAllocations(std::ostream& stream, const uint32_t steps)
+{
+	int32_t result = 0;
+	auto previous = FastMath::precision();
+	const char keys[] = "wasdqezx.,[]";
+
+	for (auto mode : { Precision::EXACT, Precision::FAST })
+	{
+		FastMath::setPrecision(mode);
+
+		for (auto placement : { Placement::NEAR_BORDER, Placement::AWAY_FROM_BORDER })
+		{
+			auto robots = makeRobots(placement);
+			auto image = Mat(m_area, CV_8UC3, Scalar(0xFF, 0xFF, 0xFF));
+
+			// The first step fills the cached polygons.
+			for (auto& robot : robots)
+			{
+				robot.doSomething(keys[0]);
+				robot.draw(image);
+			}
+
+			uint64_t allocations = AllocationCounter::allocations();
+			for (uint32_t step = 0; step < steps; step++)
+			{
+				for (size_t index = 0; index < robots.size(); index++)
+				{
+					robots[index].doSomething(keys[(index + step) % (sizeof(keys) - 1)]);
+					robots[index].draw(image);
+				}
+			}
+			allocations = AllocationCounter::allocations() - allocations;
+
+			string name = string("tick+draw/") + (mode == Precision::FAST ? "fast/" : "exact/") + placementName(placement);
+			bool passed = allocations == 0;
+			stream << left << setw(40) << name << right << setw(12) << allocations << " == 0" << (passed == true ? "  ok" : "  FAILED") << endl;
+			if (passed == false)
+			{
+				result = -1;
+			}
+		}
+	}
+
+	FastMath::setPrecision(previous);
+
+	return result;
+}
+
+Placement Benchmark::placement() const
+{
+	return m_placement;
+}
+
+std::vector<WarRobot>& Benchmark::robots()
+{
+	return m_robots;
+}
+
+cv::Mat& Benchmark::image()
+{
+	return m_image;
+}
+
+cv::Size2i Benchmark::area() const
+{
+	return m_area;
+}
+
+uint32_t Benchmark::seed() const
+{
+	return m_seed;
+}
+
+void Benchmark::print(std::ostream& stream, const std::vector<BenchmarkResult>& results)
+{
+	stream << left << setw(50) << "benchmark" << setw(18) << "placement"
+	       << right << setw(12) << "ns/op" << setw(12) << "allocs/op" << setw(16) << "ops/s" << endl;
+
+	for (auto& result : results)
+	{
+		stream << left << setw(50) << result.name << setw(18) << placementName(result.placement)
+		       << right << fixed
+		       << setw(12) << setprecision(2) << result.nanosecondsPerOperation
+		       << setw(12) << setprecision(2) << result.allocationsPerOperation
+		       << setw(16) << setprecision(0) << result.operationsPerSecond << endl;
+	}
+}
+
+void Benchmark::printJson(std::ostream& stream, const std::vector<BenchmarkResult>& results)
+{
+	stream << "{" << endl;
+	stream << "  \"instruction_set\": \"" << RobotFleet::instructionSet() << "\"," << endl;
+	stream << "  \"results\": [" << endl;
+
+	for (size_t index = 0; index < results.size(); index++)
+	{
+		auto& result = results[index];
+		stream << "    { \"name\": \"" << result.name << "\""
+		       << ", \"placement\": \"" << placementName(result.placement) << "\""
+		       << ", \"operations\": " << result.operations
+		       << ", \"ns_per_op\": " << setprecision(6) << result.nanosecondsPerOperation
+		       << ", \"allocs_per_op\": " << result.allocationsPerOperation
+		       << ", \"ops_per_second\": " << result.operationsPerSecond
+		       << " }" << (index + 1 < results.size() ? "," : "") << endl;
+	}
+
+	stream << "  ]" << endl;
+	stream << "}" << endl;
+}
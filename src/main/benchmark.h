@@ -0,0 +1,124 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "war_robot.h"
+#include "allocation_counter.h"
+
+enum class Placement
+{
+	NEAR_BORDER,
+	AWAY_FROM_BORDER
+};
+
+struct BenchmarkResult
+{
+	std::string name;
+	Placement placement;
+	uint64_t operations;
+	double nanosecondsPerOperation;
+	double allocationsPerOperation;
+	double operationsPerSecond;
+};
+
+// Runs every registered module's cases once per placement. A module's cases
+// live in <module>_benchmark.cpp and read the current robots, image and
+// placement from the Benchmark they are given. checkAllocations() fails unless
+// the robot tick and draw run without touching the heap once warmed up.
+class Benchmark
+{
+public:
+	typedef void (*Registration)(Benchmark& benchmark);
+
+	Benchmark(
+		const uint32_t poses = 1024,
+		const double minimumSeconds = 0.2,
+		const uint32_t seed = 1
+	);
+	~Benchmark() = default;
+
+	std::vector<BenchmarkResult> run();
+	int32_t checkAllocations(std::ostream& stream, const uint32_t steps = 64);
+
+	Placement placement() const;
+	std::vector<WarRobot>& robots();
+	cv::Mat& image();
+	cv::Size2i area() const;
+	uint32_t seed() const;
+
+	template <typename Operation>
+	void measure(const std::string& name, size_t count, Operation operation, const size_t batch = 1);
+
+	static void print(std::ostream& stream, const std::vector<BenchmarkResult>& results);
+	static void printJson(std::ostream& stream, const std::vector<BenchmarkResult>& results);
+
+private:
+	std::vector<WarRobot> makeRobots(Placement placement);
+
+	uint32_t m_poses;
+	double m_minimumSeconds;
+	uint32_t m_seed;
+	cv::Size2i m_area;
+	volatile float m_sink;
+	Placement m_placement;
+	std::vector<WarRobot> m_robots;
+	cv::Mat m_image;
+	std::vector<BenchmarkResult> m_results;
+};
+
+void benchmarkRobot(Benchmark& benchmark);
+void benchmarkFastMath(Benchmark& benchmark);
+void benchmarkRobotGeometry(Benchmark& benchmark);
+void benchmarkRenderer(Benchmark& benchmark);
+void benchmarkPlanner(Benchmark& benchmark);
+void benchmarkProjectilePool(Benchmark& benchmark);
+void benchmarkTurretSolver(Benchmark& benchmark);
+void benchmarkEventIntegrator(Benchmark& benchmark);
+void benchmarkArenaExecutor(Benchmark& benchmark);
+void benchmarkVectorEnv(Benchmark& benchmark);
+void benchmarkLidar(Benchmark& benchmark);
+void benchmarkObstacleMap(Benchmark& benchmark);
+void benchmarkRobotFleet(Benchmark& benchmark);
+
+template <typename Operation>
+void Benchmark::measure(const std::string& name, size_t count, Operation operation, const size_t batch)
+{
+	for (size_t index = 0; index < count; index++)
+	{
+		m_sink = m_sink + operation(index);
+	}
+
+	uint64_t operations = 0;
+	double seconds = 0.0;
+	uint64_t allocations = AllocationCounter::allocations();
+	auto start = std::chrono::steady_clock::now();
+
+	while (seconds < m_minimumSeconds)
+	{
+		float sink = 0.0f;
+		for (size_t index = 0; index < count; index++)
+		{
+			sink += operation(index);
+		}
+		m_sink = m_sink + sink;
+		operations += count * batch;
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	allocations = AllocationCounter::allocations() - allocations;
+
+	BenchmarkResult result =
+	{
+		name,
+		m_placement,
+		operations,
+		seconds * 1e9 / operations,
+		static_cast<double>(allocations) / operations,
+		operations / seconds
+	};
+
+	m_results.push_back(result);
+}
@@ -1,4 +1,5 @@
 #include "combat_module.h"
+#include "fast_math.h"
 #include "opencv2/imgproc.hpp"
 
 using namespace cv;
@@ -17,9 +18,39 @@ CombatModule::CombatModule(
 	m_center(center),
 	m_angle(angle),
 	m_angularSpeed(angularSpeed),
-	m_border(border)
+	m_border(border),
+	m_rotation(cv::Point2f(0, 0), angle),
+	m_mount(cv::Point2f(0, 0), 0.0f),
+	m_frame(cv::Point2f(0, 0), angle)
 {
-	m_boundaryPoints = boundaryPoints();
+	m_tower.setLocal(
+	{
+		Point2f( m_length / 2.0f,  m_width / 4.0f),
+		Point2f( 0.0f           ,  m_width / 2.0f),
+		Point2f(-m_length / 2.0f,  m_width / 4.0f),
+		Point2f(-m_length / 2.0f, -m_width / 4.0f),
+		Point2f( 0.0f           , -m_width / 2.0f),
+		Point2f( m_length / 2.0f, -m_width / 4.0f)
+	});
+
+	m_gunShape =
+	{
+		Point2f( m_length / 2.0f,  m_width / 12.0f),
+		Point2f(-m_length / 2.0f,  m_width / 12.0f),
+		Point2f(-m_length / 2.0f, -m_width / 12.0f),
+		Point2f( m_length / 2.0f, -m_width / 12.0f)
+	};
+
+	PolygonPoints gun;
+	for (auto& point : m_gunShape)
+	{
+		gun.append(Point2f(point.x + m_length, point.y));
+	}
+	m_gun.setLocal(gun);
+
+	PolygonPoints boundary = m_tower.local();
+	boundary.append(gun.begin(), gun.end());
+	m_boundary.setLocal(boundary);
 }
 
 void CombatModule::setAngularSpeed(const float angularSpeed)
@@ -34,26 +65,18 @@ float CombatModule::angularSpeed() const
 
 int32_t CombatModule::rotate(Rotation rotation)
 {
-	auto rotate = [this](Point2f& point, const float angle)
-	{
-		auto bufferPoint = point;
-
-		point.x = bufferPoint.x * cosf(angle) - bufferPoint.y * sinf(angle);
-		point.y = bufferPoint.x * sinf(angle) + bufferPoint.y * cosf(angle);
-	};
-
 	float angle = calculateAngularDisplacement(rotation);
 
 	switch (rotation)
 	{
 		case Rotation::CLOCKWISE:
 		{
-			m_angle -= angle;
+			setAngle(m_angle - angle);
 			break;
 		}
 		case Rotation::COUNTER_CLOCKWISE:
 		{
-			m_angle += angle;
+			setAngle(m_angle + angle);
 			break;
 		}
 		default:
@@ -62,11 +85,6 @@ int32_t CombatModule::rotate(Rotation rotation)
 		}
 	}
 
-	for (auto& point : m_boundaryPoints)
-	{
-		rotate(point, (static_cast<int32_t>(rotation) * 2 - 1) * angle);
-	}
-
 	if (angle < m_angularSpeed)
 	{
 		return -2;
@@ -75,66 +93,36 @@ int32_t CombatModule::rotate(Rotation rotation)
 	return 0;
 }
 
-void CombatModule::rotateBoundaryPoints(const float angle)
+void CombatModule::setMountAngle(const float angle)
 {
-	auto rotate = [this](Point2f& point, const float angle)
-	{
-		auto bufferPoint = point;
-
-		point.x = bufferPoint.x * cosf(angle) - bufferPoint.y * sinf(angle);
-		point.y = bufferPoint.x * sinf(angle) + bufferPoint.y * cosf(angle);
-	};
-
-	m_boundaryPoints = boundaryPoints();
-
-	for (auto& point : m_boundaryPoints)
-	{
-		rotate(point, angle);
-	}
+	m_mount.setAngle(angle);
 }
 
-vector<cv::Point2f> CombatModule::towerPoints()
+float CombatModule::mountAngle() const
 {
-	auto point = [this](const float x, const float y)
-	{
-		auto point = cv::Point2f();
-		point.x = x * cosf(angle()) - y * sinf(angle());
-		point.y = x * sinf(angle()) + y * cosf(angle());
-		return point;
-	};
-
-	vector<Point2f> points =
-	{
-		point( m_length / 2.0f,  m_width / 4.0f),
-		point( 0.0            ,  m_width / 2.0f),
-		point(-m_length / 2.0f,  m_width / 4.0f),
-		point(-m_length / 2.0f, -m_width / 4.0f),
-		point( 0.0            , -m_width / 2.0f),	
-		point( m_length / 2.0f, -m_width / 4.0f)
-	};
+	return m_mount.angle();
+}
 
-	return points;
+const PolygonPoints& CombatModule::towerPoints()
+{
+	m_rotation.update();
+	return m_tower.points(m_rotation);
 }
 
-vector<cv::Point2f> CombatModule::gunPoints()
+const PolygonPoints& CombatModule::gunPoints()
 {
-	auto point = [this](const float x, const float y)
-	{
-		auto point = cv::Point2f();
-		point.x = (x + length()) * cosf(angle()) - y * sinf(angle());
-		point.y = (x + length()) * sinf(angle()) + y * cosf(angle());
-		return point;
-	};
+	m_rotation.update();
+	return m_gun.points(m_rotation);
+}
 
-	vector<Point2f> points =
-	{
-		point( m_length / 2.0f,  m_width / 12.0f),
-		point(-m_length / 2.0f,  m_width / 12.0f),
-		point(-m_length / 2.0f, -m_width / 12.0f),
-		point( m_length / 2.0f, -m_width / 12.0f)
-	};
+const PolygonPoints& CombatModule::towerShape() const
+{
+	return m_tower.local();
+}
 
-	return points;
+const PolygonPoints& CombatModule::gunShape() const
+{
+	return m_gunShape;
 }
 
 void CombatModule::setCenter(const cv::Point2f center)
@@ -150,6 +138,8 @@ cv::Point2f CombatModule::center() const
 void CombatModule::setAngle(const float angle)
 {
 	m_angle = angle;
+	m_rotation.setAngle(angle);
+	m_frame.setAngle(angle);
 }
 
 float CombatModule::angle() const
@@ -181,63 +171,80 @@ float CombatModule::calculateAngularDisplacement(Rotation rotation)
 {
 	float angle = m_angularSpeed;
 
-	for (auto& point : m_boundaryPoints)
-	{
-		float radius = hypotf(point.x - m_center.x, point.y - m_center.y);
+	m_mount.update();
+	m_frame.update(&m_mount);
 
-		auto distance = [this](Quadrant quadrant)
+	if (FastMath::precision() == Precision::FAST)
+	{
+		const float distances[] =
 		{
-			switch (quadrant)
-			{
-			case Quadrant::QUADRANT_I:
-				return fabs(center().x - border().left);
-			case Quadrant::QUADRANT_II:
-				return fabs(center().y - border().bottom);
-			case Quadrant::QUADRANT_III:
-				return fabs(center().x - border().right);
-			case Quadrant::QUADRANT_IV:
-				return fabs(center().y - border().top);
-			default:
-				return FLT_MAX;
-			}
+			fabsf(m_center.x - m_border.left),
+			fabsf(m_center.y - m_border.bottom),
+			fabsf(m_center.x - m_border.right),
+			fabsf(m_center.y - m_border.top)
 		};
-
-		auto realAngle = [this, distance, &radius, &angle](Point2f point, Rotation rotation, Quadrant quadrant)
+		angle = FastMath::rotationLimit(m_boundary.points(m_frame), m_center, distances, rotation, angle);
+	}
+	else
+	{
+		for (auto& point : m_boundary.points(m_frame))
 		{
-			float realAngle = angle;
-			if (distance(quadrant) < radius)
+			float radius = hypotf(point.x - m_center.x, point.y - m_center.y);
+
+			auto distance = [this](Quadrant quadrant)
 			{
-				float alpha = static_cast<int32_t>(quadrant) * M_PI_2;
-				float phi = atan2f((point.y - m_center.y) * cosf(alpha) - (point.x - m_center.x) * sinf(alpha),
-					               (point.y - m_center.y) * sinf(alpha) + (point.x - m_center.x) * cosf(alpha));
-				float dPhi = acosf(distance(quadrant) / radius);
-				realAngle = M_PI - dPhi - (static_cast<int32_t>(rotation) * 2 - 1) * phi;
-			}
-			if (angle > realAngle)
+				switch (quadrant)
+				{
+				case Quadrant::QUADRANT_I:
+					return fabs(center().x - border().left);
+				case Quadrant::QUADRANT_II:
+					return fabs(center().y - border().bottom);
+				case Quadrant::QUADRANT_III:
+					return fabs(center().x - border().right);
+				case Quadrant::QUADRANT_IV:
+					return fabs(center().y - border().top);
+				default:
+					return FLT_MAX;
+				}
+			};
+
+			auto realAngle = [this, distance, &radius, &angle](Point2f point, Rotation rotation, Quadrant quadrant)
 			{
-				return realAngle;
-			}
-			return angle;
-		};
-
-		angle = realAngle(point, rotation, Quadrant::QUADRANT_I  );
-		angle = realAngle(point, rotation, Quadrant::QUADRANT_II );
-		angle = realAngle(point, rotation, Quadrant::QUADRANT_III);
-		angle = realAngle(point, rotation, Quadrant::QUADRANT_IV );
+				float realAngle = angle;
+				if (distance(quadrant) < radius)
+				{
+					float alpha = static_cast<int32_t>(quadrant) * M_PI_2;
+					float phi = atan2f((point.y - m_center.y) * cosf(alpha) - (point.x - m_center.x) * sinf(alpha),
+						               (point.y - m_center.y) * sinf(alpha) + (point.x - m_center.x) * cosf(alpha));
+					float dPhi = acosf(distance(quadrant) / radius);
+					realAngle = M_PI - dPhi - (static_cast<int32_t>(rotation) * 2 - 1) * phi;
+				}
+				if (angle > realAngle)
+				{
+					return realAngle;
+				}
+				return angle;
+			};
+
+			angle = realAngle(point, rotation, Quadrant::QUADRANT_I  );
+			angle = realAngle(point, rotation, Quadrant::QUADRANT_II );
+			angle = realAngle(point, rotation, Quadrant::QUADRANT_III);
+			angle = realAngle(point, rotation, Quadrant::QUADRANT_IV );
+		}
 	}
 
 	return angle;
 }
 
-vector<Point2f> CombatModule::boundaryPoints()
+PolygonPoints CombatModule::boundaryPoints()
 {
-	vector<Point2f> points;
+	PolygonPoints points;
 
-	auto tower = towerPoints();
-	points.insert(points.end(), tower.begin(), tower.end());
+	auto& tower = towerPoints();
+	points.append(tower.begin(), tower.end());
 	
-	auto gun = gunPoints();
-	points.insert(points.end(), gun.begin(), gun.end());
+	auto& gun = gunPoints();
+	points.append(gun.begin(), gun.end());
 
 	return points;
 }
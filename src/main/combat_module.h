@@ -15,10 +15,15 @@ public:
 	~CombatModule() = default;
 
 	int32_t rotate(Rotation rotation);
-	void rotateBoundaryPoints(const float angle);
 
-	std::vector<cv::Point2f> towerPoints();
-	std::vector<cv::Point2f> gunPoints();
+	void setMountAngle(const float angle);
+	float mountAngle() const;
+
+	const PolygonPoints& towerPoints();
+	const PolygonPoints& gunPoints();
+
+	const PolygonPoints& towerShape() const;
+	const PolygonPoints& gunShape() const;
 
 	void setAngularSpeed(const float speed);
 	float angularSpeed() const;
@@ -36,7 +41,7 @@ public:
 	float length() const;
 
 	float calculateAngularDisplacement(Rotation rotation);
-	std::vector<cv::Point2f> boundaryPoints();
+	PolygonPoints boundaryPoints();
 
 private:
 	cv::Point2f m_center;
@@ -44,6 +49,12 @@ private:
 	const float m_length;
 	float m_angle;
 	float m_angularSpeed;
-	std::vector<cv::Point2f> m_boundaryPoints;
 	Border m_border;
+	PolygonPoints m_gunShape;
+	Transform m_rotation;
+	Transform m_mount;
+	Transform m_frame;
+	CachedPolygon m_tower;
+	CachedPolygon m_gun;
+	CachedPolygon m_boundary;
 };
@@ -0,0 +1,295 @@
+#include "command_log.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define BUFFER_SIZE 65536
+
+using namespace std;
+
+namespace
+{
+	const char MAGIC[4] = { 'W', 'R', 'C', 'L' };
+}
+
+CommandLogWriter::CommandLogWriter() :
+	m_lastTick(0),
+	m_commands(0)
+{
+	m_buffer.reserve(BUFFER_SIZE);
+}
+
+CommandLogWriter::~CommandLogWriter()
+{
+	close();
+}
+
+int32_t CommandLogWriter::open(const std::string& path)
+{
+	close();
+
+	m_file.open(path, ios::binary | ios::trunc);
+	if (m_file.is_open() == false)
+	{
+		return -1;
+	}
+
+	CommandLogHeader header = { { MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3] }, COMMAND_LOG_VERSION, 0 };
+	m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	m_lastTick = 0;
+	m_commands = 0;
+
+	return m_file.good() == true ? 0 : -1;
+}
+
+int32_t CommandLogWriter::append(const uint64_t tick, const char key)
+{
+	if (m_file.is_open() == false || tick < m_lastTick)
+	{
+		return -1;
+	}
+
+	uint64_t delta = tick - m_lastTick;
+	while (delta >= 0x80)
+	{
+		m_buffer.push_back(static_cast<uint8_t>(delta | 0x80));
+		delta >>= 7;
+	}
+	m_buffer.push_back(static_cast<uint8_t>(delta));
+	m_buffer.push_back(static_cast<uint8_t>(key));
+
+	m_lastTick = tick;
+	m_commands++;
+
+	if (m_buffer.size() + 16 > BUFFER_SIZE)
+	{
+		return flush();
+	}
+
+	return 0;
+}
+
+int32_t CommandLogWriter::flush()
+{
+	if (m_file.is_open() == false)
+	{
+		return -1;
+	}
+
+	m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+	m_file.flush();
+	m_buffer.clear();
+
+	return m_file.good() == true ? 0 : -1;
+}
+
+void CommandLogWriter::close()
+{
+	if (m_file.is_open() == false)
+	{
+		return;
+	}
+
+	flush();
+	m_file.close();
+}
+
+bool CommandLogWriter::isOpen() const
+{
+	return m_file.is_open();
+}
+
+uint64_t CommandLogWriter::commands() const
+{
+	return m_commands;
+}
+
+CommandLogReader::CommandLogReader() :
+	m_data(nullptr),
+	m_size(0),
+	m_offset(0),
+	m_tick(0),
+#ifdef _WIN32
+	m_file(INVALID_HANDLE_VALUE),
+	m_mapping(nullptr)
+#else
+	m_file(-1)
+#endif
+{
+
+}
+
+CommandLogReader::~CommandLogReader()
+{
+	close();
+}
+
+int32_t CommandLogReader::open(const std::string& path)
+{
+	close();
+
+#ifdef _WIN32
+	m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+	{
+		return -1;
+	}
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(m_file, &size) == FALSE)
+	{
+		close();
+		return -1;
+	}
+	m_size = static_cast<uint64_t>(size.QuadPart);
+
+	if (m_size >= sizeof(CommandLogHeader))
+	{
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping != nullptr)
+		{
+			m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		}
+	}
+#else
+	m_file = ::open(path.c_str(), O_RDONLY);
+	if (m_file < 0)
+	{
+		return -1;
+	}
+
+	struct stat status;
+	if (fstat(m_file, &status) != 0)
+	{
+		close();
+		return -1;
+	}
+	m_size = static_cast<uint64_t>(status.st_size);
+
+	if (m_size >= sizeof(CommandLogHeader))
+	{
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+		if (data != MAP_FAILED)
+		{
+			madvise(data, m_size, MADV_SEQUENTIAL);
+			m_data = static_cast<const uint8_t*>(data);
+		}
+	}
+#endif
+
+	if (m_data == nullptr)
+	{
+		close();
+		return -2;
+	}
+
+	CommandLogHeader header;
+	memcpy(&header, m_data, sizeof(header));
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != COMMAND_LOG_VERSION)
+	{
+		close();
+		return -2;
+	}
+
+	rewind();
+
+	return 0;
+}
+
+void CommandLogReader::close()
+{
+#ifdef _WIN32
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping != nullptr)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+	}
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_file);
+		m_file = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_data != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+	}
+	if (m_file >= 0)
+	{
+		::close(m_file);
+		m_file = -1;
+	}
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+	m_offset = 0;
+	m_tick = 0;
+}
+
+int32_t CommandLogReader::next(uint64_t& tick, char& key)
+{
+	if (m_data == nullptr || m_offset >= m_size)
+	{
+		return -1;
+	}
+
+	uint64_t delta = 0;
+	uint32_t shift = 0;
+	while (true)
+	{
+		if (m_offset >= m_size || shift > 63)
+		{
+			return -2;
+		}
+
+		uint8_t byte = m_data[m_offset++];
+		delta |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		shift += 7;
+
+		if ((byte & 0x80) == 0)
+		{
+			break;
+		}
+	}
+
+	if (m_offset >= m_size)
+	{
+		return -2;
+	}
+
+	m_tick += delta;
+	tick = m_tick;
+	key = static_cast<char>(m_data[m_offset++]);
+
+	return 0;
+}
+
+void CommandLogReader::rewind()
+{
+	m_offset = sizeof(CommandLogHeader);
+	m_tick = 0;
+}
+
+bool CommandLogReader::isOpen() const
+{
+	return m_data != nullptr;
+}
+
+uint64_t CommandLogReader::size() const
+{
+	return m_size;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define COMMAND_LOG_VERSION 1
+
+struct CommandLogHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t reserved;
+};
+
+// Each command is stored as the LEB128 varint of its tick delta followed by
+// the key byte, so a headless run costs two bytes per command.
+class CommandLogWriter
+{
+public:
+	CommandLogWriter();
+	~CommandLogWriter();
+
+	CommandLogWriter(const CommandLogWriter&) = delete;
+	CommandLogWriter& operator=(const CommandLogWriter&) = delete;
+
+	int32_t open(const std::string& path);
+	int32_t append(const uint64_t tick, const char key);
+	int32_t flush();
+	void close();
+
+	bool isOpen() const;
+	uint64_t commands() const;
+
+private:
+	std::ofstream m_file;
+	std::vector<uint8_t> m_buffer;
+	uint64_t m_lastTick;
+	uint64_t m_commands;
+};
+
+// Reads a log through a read-only memory mapping, so the file is paged in
+// on demand instead of being loaded.
+class CommandLogReader
+{
+public:
+	CommandLogReader();
+	~CommandLogReader();
+
+	CommandLogReader(const CommandLogReader&) = delete;
+	CommandLogReader& operator=(const CommandLogReader&) = delete;
+
+	int32_t open(const std::string& path);
+	void close();
+
+	int32_t next(uint64_t& tick, char& key);
+	void rewind();
+
+	bool isOpen() const;
+	uint64_t size() const;
+
+private:
+	const uint8_t* m_data;
+	uint64_t m_size;
+	uint64_t m_offset;
+	uint64_t m_tick;
+#ifdef _WIN32
+	void* m_file;
+	void* m_mapping;
+#else
+	int m_file;
+#endif
+};
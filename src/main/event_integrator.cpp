@@ -0,0 +1,813 @@
+#include "event_integrator.h"
+#include "profiler.h"
+#include "war_robot.h"
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <random>
+
+using namespace std;
+using namespace cv;
+
+namespace
+{
+	const double NEVER = numeric_limits<double>::infinity();
+}
+
+EventIntegrator::EventIntegrator(const Border border) :
+	m_border(border),
+	m_time(0.0),
+	m_events(0)
+{
+
+}
+
+size_t EventIntegrator::add(Robot& robot, const cv::Point2f velocity, const float angularVelocity)
+{
+	Body body;
+	body.robot = &robot;
+	body.center = robot.center();
+	body.angle = robot.angle();
+	body.time = m_time;
+	body.velocity = velocity;
+	body.angularVelocity = angularVelocity;
+	body.radius = 0.0f;
+	body.version = 0;
+
+	float cosine = cosf(body.angle);
+	float sine = sinf(body.angle);
+
+	auto footprint = robot.footprint();
+	body.local.size = footprint.size;
+	for (size_t part = 0; part < footprint.size; part++)
+	{
+		auto& points = footprint.parts[part];
+		auto& local = body.local.parts[part];
+		local.resize(points.size());
+		for (size_t index = 0; index < points.size(); index++)
+		{
+			auto offset = points[index] - body.center;
+			local[index] = Point2f(offset.x * cosine + offset.y * sine, -offset.x * sine + offset.y * cosine);
+			body.radius = max(body.radius, hypotf(local[index].x, local[index].y));
+		}
+	}
+
+	m_bodies.push_back(body);
+	schedule(static_cast<uint32_t>(m_bodies.size() - 1));
+
+	return m_bodies.size() - 1;
+}
+
+void EventIntegrator::clear()
+{
+	m_bodies.clear();
+	m_queue.clear();
+	m_contacts.clear();
+	m_time = 0.0;
+	m_events = 0;
+}
+
+size_t EventIntegrator::size() const
+{
+	return m_bodies.size();
+}
+
+void EventIntegrator::setBorder(const Border border)
+{
+	m_border = border;
+	m_queue.clear();
+
+	for (uint32_t index = 0; index < m_bodies.size(); index++)
+	{
+		schedule(index, index + 1);
+	}
+}
+
+Border EventIntegrator::border() const
+{
+	return m_border;
+}
+
+int32_t EventIntegrator::setVelocity(size_t index, const cv::Point2f velocity, const float angularVelocity)
+{
+	if (index >= m_bodies.size())
+	{
+		return -1;
+	}
+
+	auto& body = m_bodies[index];
+	rebase(body, m_time);
+	body.velocity = velocity;
+	body.angularVelocity = angularVelocity;
+	body.version++;
+
+	if (m_queue.size() > 4 * (m_bodies.size() * m_bodies.size() + m_bodies.size()) + 64)
+	{
+		auto stale = [this](const Event& event)
+		{
+			return m_bodies[event.first].version != event.firstVersion ||
+				(event.second != BORDER_CONTACT && m_bodies[event.second].version != event.secondVersion);
+		};
+		m_queue.erase(remove_if(m_queue.begin(), m_queue.end(), stale), m_queue.end());
+		make_heap(m_queue.begin(), m_queue.end(), greater<Event>());
+	}
+
+	schedule(static_cast<uint32_t>(index));
+
+	return 0;
+}
+
+cv::Point2f EventIntegrator::velocity(size_t index) const
+{
+	return m_bodies[index].velocity;
+}
+
+float EventIntegrator::angularVelocity(size_t index) const
+{
+	return m_bodies[index].angularVelocity;
+}
+
+int32_t EventIntegrator::advance(const double duration)
+{
+	PROFILE_SCOPE("EventIntegrator::advance");
+
+	if (duration < 0.0)
+	{
+		return -1;
+	}
+
+	m_contacts.clear();
+	double target = m_time + duration;
+
+	while (m_queue.empty() == false && m_queue.front().time <= target)
+	{
+		pop_heap(m_queue.begin(), m_queue.end(), greater<Event>());
+		auto event = m_queue.back();
+		m_queue.pop_back();
+
+		bool border = event.second == BORDER_CONTACT;
+		if (m_bodies[event.first].version != event.firstVersion ||
+			(border == false && m_bodies[event.second].version != event.secondVersion))
+		{
+			continue;
+		}
+
+		m_time = max(m_time, event.time);
+		m_events++;
+
+		if (event.contact == false)
+		{
+			bool contact = false;
+			double time = border == true ?
+				borderTime(m_bodies[event.first], contact) :
+				pairTime(m_bodies[event.first], m_bodies[event.second], contact);
+			push(time, event.first, event.second, contact);
+			continue;
+		}
+
+		auto& first = m_bodies[event.first];
+		rebase(first, m_time);
+		first.velocity = Point2f(0, 0);
+		first.angularVelocity = 0.0f;
+		first.version++;
+
+		if (border == false)
+		{
+			auto& second = m_bodies[event.second];
+			rebase(second, m_time);
+			second.velocity = Point2f(0, 0);
+			second.angularVelocity = 0.0f;
+			second.version++;
+		}
+
+		ContactEvent contact = { m_time, event.first, event.second };
+		m_contacts.push_back(contact);
+
+		schedule(event.first);
+		if (border == false)
+		{
+			schedule(event.second);
+		}
+	}
+
+	m_time = target;
+
+	for (auto& body : m_bodies)
+	{
+		if (moving(body) == true)
+		{
+			rebase(body, m_time);
+		}
+	}
+
+	return m_contacts.empty() == true ? 0 : -2;
+}
+
+const std::vector<ContactEvent>& EventIntegrator::contacts() const
+{
+	return m_contacts;
+}
+
+double EventIntegrator::time() const
+{
+	return m_time;
+}
+
+uint64_t EventIntegrator::events() const
+{
+	return m_events;
+}
+
+cv::Point2f EventIntegrator::center(size_t index) const
+{
+	Point2f center;
+	float angle;
+	pose(m_bodies[index], m_time, center, angle);
+
+	return center;
+}
+
+float EventIntegrator::angle(size_t index) const
+{
+	Point2f center;
+	float angle;
+	pose(m_bodies[index], m_time, center, angle);
+
+	return angle;
+}
+
+int32_t EventIntegrator::validate(std::ostream& stream, const uint32_t pairs)
+{
+	const double duration = 2.0;
+	const double sampling = 1e-3;
+
+	mt19937 random(1);
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	// Deepest penetration past the start (or past touching) before the first
+	// reported contact, and the largest gap left at a reported contact of a
+	// pair that started apart.
+	float worstPenetration[2] = { -FLT_MAX, -FLT_MAX };
+	float worstGap[2] = { -FLT_MAX, -FLT_MAX };
+
+	for (uint32_t pair = 0; pair < pairs; pair++)
+	{
+		bool rotating = pair % 2 == 1;
+
+		WarRobot robots[2];
+		EventIntegrator integrator({ 1e6f, 1e6f, -1e6f, -1e6f });
+		for (size_t index = 0; index < 2; index++)
+		{
+			robots[index].setAngle(static_cast<float>(2.0 * M_PI) * unit(random));
+			robots[index].setCenter(index == 0 ? 0.0f : 300.0f * unit(random) - 150.0f, index == 0 ? 0.0f : 300.0f * unit(random) - 150.0f);
+			integrator.add(
+				robots[index],
+				Point2f(160.0f * unit(random) - 80.0f, 40.0f * unit(random) - 20.0f),
+				rotating == true ? unit(random) - 0.5f : 0.0f
+			);
+		}
+
+		auto bodies = integrator.m_bodies;
+		auto distance = [&integrator, &bodies](const double time)
+		{
+			Footprint first;
+			Footprint second;
+			integrator.footprint(bodies[0], time, first);
+			integrator.footprint(bodies[1], time, second);
+
+			float result = FLT_MAX;
+			for (size_t i = 0; i < first.size; i++)
+			{
+				for (size_t j = 0; j < second.size; j++)
+				{
+					result = min(result, separation(first.parts[i], second.parts[j]));
+				}
+			}
+			return result;
+		};
+
+		integrator.advance(duration);
+		double contact = integrator.contacts().empty() == true ? duration : integrator.contacts().front().time;
+
+		float start = min(distance(0.0), 0.0f);
+		for (double time = 0.0; time < contact; time += sampling)
+		{
+			worstPenetration[rotating] = max(worstPenetration[rotating], start - distance(time));
+		}
+
+		if (integrator.contacts().empty() == false && start == 0.0f)
+		{
+			worstGap[rotating] = max(worstGap[rotating], distance(contact));
+		}
+	}
+
+	int32_t result = 0;
+	const struct
+	{
+		const char* name;
+		float value;
+	}
+	checks[] =
+	{
+		{ "contact/translating", worstPenetration[0] },
+		{ "contact/rotating", worstPenetration[1] },
+		{ "gap/translating", worstGap[0] },
+		{ "gap/rotating", worstGap[1] }
+	};
+
+	for (auto& check : checks)
+	{
+		bool passed = check.value <= CONTACT_TOLERANCE;
+		stream << left << setw(24) << check.name << right << fixed << setprecision(6)
+		       << setw(12) << check.value << " <= " << CONTACT_TOLERANCE << (passed == true ? "  ok" : "  FAILED") << endl;
+		if (passed == false)
+		{
+			result = -1;
+		}
+	}
+
+	return result;
+}
+
+void EventIntegrator::pose(const Body& body, const double time, cv::Point2f& center, float& angle) const
+{
+	float elapsed = static_cast<float>(time - body.time);
+	float turn = body.angularVelocity * elapsed;
+	angle = body.angle + turn;
+
+	// Integral of the heading cosine and sine over the elapsed time; the robot
+	// follows an arc when it turns and a line otherwise.
+	float cosine;
+	float sine;
+	if (fabsf(turn) < 1e-6f)
+	{
+		cosine = elapsed * cosf(body.angle);
+		sine = elapsed * sinf(body.angle);
+	}
+	else
+	{
+		cosine = (sinf(angle) - sinf(body.angle)) / body.angularVelocity;
+		sine = (cosf(body.angle) - cosf(angle)) / body.angularVelocity;
+	}
+
+	center.x = body.center.x + body.velocity.x * cosine - body.velocity.y * sine;
+	center.y = body.center.y + body.velocity.x * sine + body.velocity.y * cosine;
+}
+
+void EventIntegrator::footprint(const Body& body, const double time, Footprint& footprint) const
+{
+	Point2f center;
+	float angle;
+	pose(body, time, center, angle);
+
+	float cosine = cosf(angle);
+	float sine = sinf(angle);
+
+	footprint.size = body.local.size;
+	for (size_t part = 0; part < body.local.size; part++)
+	{
+		auto& local = body.local.parts[part];
+		auto& points = footprint.parts[part];
+		points.resize(local.size());
+		for (size_t index = 0; index < local.size(); index++)
+		{
+			points[index].x = center.x + local[index].x * cosine - local[index].y * sine;
+			points[index].y = center.y + local[index].x * sine + local[index].y * cosine;
+		}
+	}
+}
+
+void EventIntegrator::rebase(Body& body, const double time)
+{
+	Point2f center;
+	float angle;
+	pose(body, time, center, angle);
+
+	body.center = center;
+	body.angle = angle;
+	body.time = time;
+
+	body.robot->setCenter(body.center.x, body.center.y);
+	body.robot->setAngle(body.angle);
+}
+
+void EventIntegrator::schedule(uint32_t index, uint32_t from)
+{
+	auto& body = m_bodies[index];
+
+	bool contact = false;
+	double time = borderTime(body, contact);
+	push(time, index, BORDER_CONTACT, contact);
+
+	for (uint32_t other = from; other < m_bodies.size(); other++)
+	{
+		if (other == index)
+		{
+			continue;
+		}
+
+		time = pairTime(body, m_bodies[other], contact);
+		push(time, index, other, contact);
+	}
+}
+
+void EventIntegrator::push(const double time, uint32_t first, uint32_t second, const bool contact)
+{
+	if (time == NEVER)
+	{
+		return;
+	}
+
+	Event event =
+	{
+		time,
+		first,
+		second,
+		m_bodies[first].version,
+		second == BORDER_CONTACT ? 0 : m_bodies[second].version,
+		contact
+	};
+
+	m_queue.push_back(event);
+	push_heap(m_queue.begin(), m_queue.end(), greater<Event>());
+}
+
+double EventIntegrator::borderTime(const Body& body, bool& contact) const
+{
+	if (moving(body) == false)
+	{
+		return NEVER;
+	}
+
+	if (body.angularVelocity != 0.0f)
+	{
+		return advancement(body, nullptr, contact);
+	}
+
+	auto velocity = worldVelocity(body);
+	Footprint current;
+	footprint(body, m_time, current);
+
+	double time = NEVER;
+	for (size_t part = 0; part < current.size; part++)
+	{
+		for (auto& point : current.parts[part])
+		{
+			if (velocity.x > 0.0f)
+			{
+				time = min(time, static_cast<double>((m_border.right - point.x) / velocity.x));
+			}
+			else if (velocity.x < 0.0f)
+			{
+				time = min(time, static_cast<double>((m_border.left - point.x) / velocity.x));
+			}
+
+			if (velocity.y > 0.0f)
+			{
+				time = min(time, static_cast<double>((m_border.top - point.y) / velocity.y));
+			}
+			else if (velocity.y < 0.0f)
+			{
+				time = min(time, static_cast<double>((m_border.bottom - point.y) / velocity.y));
+			}
+		}
+	}
+
+	contact = true;
+	return m_time + max(time, 0.0);
+}
+
+double EventIntegrator::pairTime(const Body& first, const Body& second, bool& contact) const
+{
+	if (moving(first) == false && moving(second) == false)
+	{
+		return NEVER;
+	}
+
+	if (first.angularVelocity != 0.0f || second.angularVelocity != 0.0f)
+	{
+		return advancement(first, &second, contact);
+	}
+
+	// Both robots translate, so their bounding circles meet on a quadratic in
+	// time and the footprints on a swept separating-axis test.
+	Point2f firstCenter;
+	Point2f secondCenter;
+	float angle;
+	pose(first, m_time, firstCenter, angle);
+	pose(second, m_time, secondCenter, angle);
+
+	auto velocity = worldVelocity(first) - worldVelocity(second);
+	auto offset = firstCenter - secondCenter;
+	float reach = first.radius + second.radius;
+
+	float a = velocity.dot(velocity);
+	float b = offset.dot(velocity);
+	float c = offset.dot(offset) - reach * reach;
+	float discriminant = b * b - a * c;
+	if (a == 0.0f || discriminant < 0.0f || -b + sqrtf(discriminant) < 0.0f)
+	{
+		return NEVER;
+	}
+
+	Footprint firstFootprint;
+	Footprint secondFootprint;
+	footprint(first, m_time, firstFootprint);
+	footprint(second, m_time, secondFootprint);
+
+	// Parts that already overlap touch right away if the motion pushes them
+	// deeper. The separation of translating polygons is convex in time, so
+	// parts that do not get deeper now never will.
+	auto step = velocity * (CONTACT_TOLERANCE / sqrtf(a));
+
+	double time = NEVER;
+	for (size_t i = 0; i < firstFootprint.size; i++)
+	{
+		for (size_t j = 0; j < secondFootprint.size; j++)
+		{
+			double partTime = sweep(firstFootprint.parts[i], secondFootprint.parts[j], velocity);
+			if (partTime < 0.0)
+			{
+				auto moved = firstFootprint.parts[i];
+				for (auto& point : moved)
+				{
+					point = point + step;
+				}
+
+				if (separation(moved, secondFootprint.parts[j]) < separation(firstFootprint.parts[i], secondFootprint.parts[j]))
+				{
+					contact = true;
+					return m_time;
+				}
+				continue;
+			}
+			time = min(time, partTime);
+		}
+	}
+
+	contact = true;
+	return m_time + time;
+}
+
+double EventIntegrator::advancement(const Body& first, const Body* second, bool& contact) const
+{
+	float linear = hypotf(first.velocity.x, first.velocity.y);
+	float bound = linear + fabsf(first.angularVelocity) * first.radius;
+	if (second != nullptr)
+	{
+		float secondLinear = hypotf(second->velocity.x, second->velocity.y);
+		linear += secondLinear;
+		bound += secondLinear + fabsf(second->angularVelocity) * second->radius;
+	}
+
+	if (bound == 0.0f)
+	{
+		return NEVER;
+	}
+
+	// Robots spinning in place never leave their bounding circles.
+	if (linear == 0.0f)
+	{
+		Point2f center;
+		float angle;
+		pose(first, m_time, center, angle);
+
+		float clearance;
+		if (second == nullptr)
+		{
+			clearance = min(min(m_border.right - center.x, center.x - m_border.left), min(m_border.top - center.y, center.y - m_border.bottom)) - first.radius;
+		}
+		else
+		{
+			Point2f secondCenter;
+			pose(*second, m_time, secondCenter, angle);
+			auto offset = center - secondCenter;
+			clearance = hypotf(offset.x, offset.y) - first.radius - second->radius;
+		}
+
+		if (clearance > CONTACT_TOLERANCE)
+		{
+			return NEVER;
+		}
+	}
+
+	double time = m_time;
+	double horizon = m_time + EVENT_HORIZON;
+	float current = gap(first, second, time);
+
+	// Robots that already overlap advance against their current depth
+	// instead, so they touch as soon as they would get any deeper.
+	float depth = second != nullptr && current < -CONTACT_TOLERANCE ? current : 0.0f;
+	auto clearance = [this, &first, second, depth](const double time)
+	{
+		return gap(first, second, time) - depth;
+	};
+	current -= depth;
+
+	contact = false;
+
+	for (uint32_t iteration = 0; iteration < CONTACT_ITERATIONS; iteration++)
+	{
+		if (current <= CONTACT_TOLERANCE)
+		{
+			if (clearance(time + CONTACT_TOLERANCE / bound) < current)
+			{
+				contact = true;
+				return time;
+			}
+			current = CONTACT_TOLERANCE;
+		}
+
+		time += current / bound;
+		if (time >= horizon)
+		{
+			return horizon;
+		}
+
+		current = clearance(time);
+	}
+
+	return time;
+}
+
+float EventIntegrator::gap(const Body& first, const Body* second, const double time) const
+{
+	Footprint firstFootprint;
+
+	if (second == nullptr)
+	{
+		footprint(first, time, firstFootprint);
+
+		float result = FLT_MAX;
+		for (size_t part = 0; part < firstFootprint.size; part++)
+		{
+			for (auto& point : firstFootprint.parts[part])
+			{
+				result = min(result, min(min(m_border.right - point.x, point.x - m_border.left), min(m_border.top - point.y, point.y - m_border.bottom)));
+			}
+		}
+
+		return result;
+	}
+
+	Point2f firstCenter;
+	Point2f secondCenter;
+	float angle;
+	pose(first, time, firstCenter, angle);
+	pose(*second, time, secondCenter, angle);
+
+	auto offset = firstCenter - secondCenter;
+	float result = hypotf(offset.x, offset.y) - first.radius - second->radius;
+	if (result > CONTACT_TOLERANCE)
+	{
+		return result;
+	}
+
+	Footprint secondFootprint;
+	footprint(first, time, firstFootprint);
+	footprint(*second, time, secondFootprint);
+
+	result = FLT_MAX;
+	for (size_t i = 0; i < firstFootprint.size; i++)
+	{
+		for (size_t j = 0; j < secondFootprint.size; j++)
+		{
+			result = min(result, separation(firstFootprint.parts[i], secondFootprint.parts[j]));
+		}
+	}
+
+	return result;
+}
+
+bool EventIntegrator::moving(const Body& body)
+{
+	return body.velocity.x != 0.0f || body.velocity.y != 0.0f || body.angularVelocity != 0.0f;
+}
+
+cv::Point2f EventIntegrator::worldVelocity(const Body& body)
+{
+	float cosine = cosf(body.angle);
+	float sine = sinf(body.angle);
+
+	return Point2f(
+		body.velocity.x * cosine - body.velocity.y * sine,
+		body.velocity.x * sine + body.velocity.y * cosine
+	);
+}
+
+// Largest gap between the projections of two convex polygons over the edge
+// normals of both: positive when they are apart (a lower bound of their
+// distance), negative by the penetration depth when they overlap.
+float EventIntegrator::separation(const PolygonPoints& first, const PolygonPoints& second)
+{
+	float result = -FLT_MAX;
+
+	for (auto edges : { &first, &second })
+	{
+		for (size_t index = 0; index < edges->size(); index++)
+		{
+			auto& from = (*edges)[index];
+			auto& to = (*edges)[(index + 1) % edges->size()];
+			auto normal = Point2f(from.y - to.y, to.x - from.x);
+			normal = normal * (1.0f / hypotf(normal.x, normal.y));
+
+			float firstMin = FLT_MAX;
+			float firstMax = -FLT_MAX;
+			for (auto& point : first)
+			{
+				float projection = normal.dot(point);
+				firstMin = min(firstMin, projection);
+				firstMax = max(firstMax, projection);
+			}
+
+			float secondMin = FLT_MAX;
+			float secondMax = -FLT_MAX;
+			for (auto& point : second)
+			{
+				float projection = normal.dot(point);
+				secondMin = min(secondMin, projection);
+				secondMax = max(secondMax, projection);
+			}
+
+			result = max(result, max(secondMin - firstMax, firstMin - secondMax));
+		}
+	}
+
+	return result;
+}
+
+// Time until `first`, translating with `velocity` relative to `second`, first
+// touches it: the latest entry over all separating axes, or never when some
+// axis stays separated. Polygons already touching count as apart so robots
+// can leave a contact; -1 means they overlap deeper than CONTACT_TOLERANCE.
+double EventIntegrator::sweep(const PolygonPoints& first, const PolygonPoints& second, const cv::Point2f velocity)
+{
+	double enter = -NEVER;
+	double exit = NEVER;
+
+	for (auto edges : { &first, &second })
+	{
+		for (size_t index = 0; index < edges->size(); index++)
+		{
+			auto& from = (*edges)[index];
+			auto& to = (*edges)[(index + 1) % edges->size()];
+			auto normal = Point2f(from.y - to.y, to.x - from.x);
+			normal = normal * (1.0f / hypotf(normal.x, normal.y));
+
+			float firstMin = FLT_MAX;
+			float firstMax = -FLT_MAX;
+			for (auto& point : first)
+			{
+				float projection = normal.dot(point);
+				firstMin = min(firstMin, projection);
+				firstMax = max(firstMax, projection);
+			}
+
+			float secondMin = FLT_MAX;
+			float secondMax = -FLT_MAX;
+			for (auto& point : second)
+			{
+				float projection = normal.dot(point);
+				secondMin = min(secondMin, projection);
+				secondMax = max(secondMax, projection);
+			}
+
+			float speed = normal.dot(velocity);
+			if (secondMin - firstMax > -CONTACT_TOLERANCE)
+			{
+				if (speed <= 0.0f)
+				{
+					return NEVER;
+				}
+				enter = max(enter, static_cast<double>(max(secondMin - firstMax, 0.0f) / speed));
+				exit = min(exit, static_cast<double>((secondMax - firstMin) / speed));
+			}
+			else if (firstMin - secondMax > -CONTACT_TOLERANCE)
+			{
+				if (speed >= 0.0f)
+				{
+					return NEVER;
+				}
+				enter = max(enter, static_cast<double>(max(firstMin - secondMax, 0.0f) / -speed));
+				exit = min(exit, static_cast<double>((secondMin - firstMax) / speed));
+			}
+			else if (speed > 0.0f)
+			{
+				exit = min(exit, static_cast<double>((secondMax - firstMin) / speed));
+			}
+			else if (speed < 0.0f)
+			{
+				exit = min(exit, static_cast<double>((secondMin - firstMax) / speed));
+			}
+		}
+	}
+
+	if (enter == -NEVER)
+	{
+		return -1.0;
+	}
+
+	return enter <= exit ? enter : NEVER;
+}
@@ -0,0 +1,36 @@
+#include "benchmark.h"
+#include "event_integrator.h"
+
+using namespace std;
+using namespace cv;
+
+void benchmarkEventIntegrator(Benchmark& benchmark)
+{
+	auto& robots = benchmark.robots();
+
+	vector<WarRobot> sparse(robots.begin(), robots.begin() + min<size_t>(8, robots.size()));
+	vector<Point2f> velocities;
+	EventIntegrator integrator(robots.front().border());
+	for (auto& robot : sparse)
+	{
+		velocities.push_back(Point2f(static_cast<float>(SPEED * 10.0), 0.0f));
+		integrator.add(robot, velocities.back());
+	}
+
+	benchmark.measure("EventIntegrator::advance", 1, [&integrator, &velocities](size_t)
+	{
+		integrator.advance(10.0);
+		for (auto& contact : integrator.contacts())
+		{
+			for (auto index : { contact.first, contact.second })
+			{
+				if (index != BORDER_CONTACT)
+				{
+					velocities[index] = velocities[index] * -1.0f;
+					integrator.setVelocity(index, velocities[index]);
+				}
+			}
+		}
+		return static_cast<float>(integrator.time());
+	}, sparse.size() * 100);
+}
@@ -0,0 +1,228 @@
+#include "fast_math.h"
+#include "war_robot.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <random>
+
+using namespace std;
+using namespace cv;
+
+namespace
+{
+	atomic<Precision> precisionMode(Precision::EXACT);
+
+	// Largest error of a lane function over `count` evenly spaced arguments.
+	template <typename Function, typename Reference>
+	double measureError(const double from, const double to, const size_t count, Function function, Reference reference)
+	{
+		float arguments[simd::LANES];
+		float results[simd::LANES];
+		double error = 0.0;
+
+		for (size_t index = 0; index < count; index += simd::LANES)
+		{
+			for (size_t lane = 0; lane < simd::LANES; lane++)
+			{
+				arguments[lane] = static_cast<float>(from + (to - from) * min(index + lane, count - 1) / (count - 1));
+			}
+
+			simd::store(results, function(simd::load(arguments)));
+
+			for (size_t lane = 0; lane < simd::LANES; lane++)
+			{
+				error = max(error, fabs(static_cast<double>(results[lane]) - reference(static_cast<double>(arguments[lane]))));
+			}
+		}
+
+		return error;
+	}
+
+	// simd::atan2 of the point at `angle` on the unit circle.
+	simd::Lane atan2Lane(const simd::Lane angle)
+	{
+		float angles[simd::LANES];
+		float sines[simd::LANES];
+		float cosines[simd::LANES];
+		simd::store(angles, angle);
+
+		for (size_t lane = 0; lane < simd::LANES; lane++)
+		{
+			sines[lane] = sinf(angles[lane]);
+			cosines[lane] = cosf(angles[lane]);
+		}
+
+		return simd::atan2(simd::load(sines), simd::load(cosines));
+	}
+
+	float excursion(WarRobot& robot)
+	{
+		auto border = robot.border();
+		float result = -FLT_MAX;
+
+		for (auto& point : robot.boundaryPoints())
+		{
+			result = max(result, max(max(point.x - border.right, border.left - point.x), max(point.y - border.top, border.bottom - point.y)));
+		}
+
+		return result;
+	}
+}
+
+void FastMath::setPrecision(const Precision precision)
+{
+	precisionMode.store(precision, memory_order_relaxed);
+}
+
+Precision FastMath::precision()
+{
+	return precisionMode.load(memory_order_relaxed);
+}
+
+float FastMath::rotationLimit(
+	const PolygonPoints& points,
+	const cv::Point2f origin,
+	const float distances[4],
+	const Rotation rotation,
+	const float limit
+)
+{
+	float offsetX[POLYGON_CAPACITY + simd::LANES];
+	float offsetY[POLYGON_CAPACITY + simd::LANES];
+
+	size_t size = points.size();
+	size_t padded = (size + simd::LANES - 1) / simd::LANES * simd::LANES;
+	for (size_t index = 0; index < padded; index++)
+	{
+		auto& point = points[index < size ? index : 0];
+		offsetX[index] = point.x - origin.x;
+		offsetY[index] = point.y - origin.y;
+	}
+
+	// Quarter turns of the quadrant frames, exact instead of cosf(k * M_PI_2).
+	const float cosines[] = { 1.0f, 0.0f, -1.0f, 0.0f };
+	const float sines[] = { 0.0f, 1.0f, 0.0f, -1.0f };
+
+	const simd::Lane sign = simd::set(static_cast<int32_t>(rotation) * 2.0f - 1.0f);
+	// Shrunk by the polynomial error bounds, which covers the polynomials but
+	// not the conditioning of acos near a ratio of 1; see validate().
+	const simd::Lane base = simd::set(static_cast<float>(M_PI) - SIMD_ATAN2_ERROR - SIMD_ACOS_ERROR);
+	simd::Lane angle = simd::set(limit);
+
+	for (size_t index = 0; index < padded; index += simd::LANES)
+	{
+		simd::Lane x = simd::load(offsetX + index);
+		simd::Lane y = simd::load(offsetY + index);
+		simd::Lane radius = simd::sqrt(simd::add(simd::mul(x, x), simd::mul(y, y)));
+
+		for (size_t quadrant = 0; quadrant < 4; quadrant++)
+		{
+			simd::Lane distance = simd::set(distances[quadrant]);
+			simd::Mask reach = simd::greater(radius, distance);
+			if (simd::bits(reach) == 0)
+			{
+				continue;
+			}
+
+			simd::Lane cosine = simd::set(cosines[quadrant]);
+			simd::Lane sine = simd::set(sines[quadrant]);
+
+			simd::Lane phi = simd::atan2(
+				simd::sub(simd::mul(y, cosine), simd::mul(x, sine)),
+				simd::add(simd::mul(y, sine), simd::mul(x, cosine))
+			);
+			simd::Lane dPhi = simd::acos(simd::div(distance, simd::max(radius, simd::set(1e-30f))));
+			simd::Lane realAngle = simd::sub(simd::sub(base, dPhi), simd::mul(sign, phi));
+
+			angle = simd::select(reach, simd::min(angle, realAngle), angle);
+		}
+	}
+
+	float angles[simd::LANES];
+	simd::store(angles, angle);
+
+	float result = limit;
+	for (size_t lane = 0; lane < simd::LANES; lane++)
+	{
+		result = min(result, angles[lane]);
+	}
+
+	return result;
+}
+
+int32_t FastMath::validate(std::ostream& stream, const uint32_t poses, const uint32_t steps)
+{
+	int32_t result = 0;
+
+	struct Check
+	{
+		const char* name;
+		double error;
+		double bound;
+	};
+
+	Check checks[] =
+	{
+		{ "acos", measureError(-1.0, 1.0, 1 << 24, [](simd::Lane x) { return simd::acos(x); }, [](double x) { return acos(x); }), SIMD_ACOS_ERROR },
+		{ "atan2", measureError(-3.14159, 3.14159, 1 << 24, [](simd::Lane x) { return atan2Lane(x); }, [](double x) { return atan2(static_cast<double>(sinf(static_cast<float>(x))), static_cast<double>(cosf(static_cast<float>(x)))); }), SIMD_ATAN2_ERROR }
+	};
+
+	for (auto& check : checks)
+	{
+		bool passed = check.error <= check.bound;
+		stream << left << setw(24) << check.name << right << scientific << setprecision(3)
+		       << setw(12) << check.error << " <= " << check.bound << (passed == true ? "  ok" : "  FAILED") << endl;
+		if (passed == false)
+		{
+			result = -1;
+		}
+	}
+
+	auto previous = precision();
+	const char keys[] = "wasdqezx.,[]";
+
+	for (auto mode : { Precision::EXACT, Precision::FAST })
+	{
+		setPrecision(mode);
+
+		mt19937 random(1);
+		uniform_real_distribution<float> unit(0.0f, 1.0f);
+		float worst = -FLT_MAX;
+
+		for (uint32_t pose = 0; pose < poses; pose++)
+		{
+			auto robot = WarRobot(60, 120, { 10, 40 }, CombatModule(), Point2f(0, 0), static_cast<float>(2.0 * M_PI) * unit(random));
+			robot.setSpeed(SPEED);
+			robot.setAngularSpeed(ANGULAR_SPEED);
+			robot.combatModule().setAngularSpeed(0.2f);
+			robot.combatModule().setAngle(static_cast<float>(2.0 * M_PI) * unit(random));
+
+			// Start anywhere inside, most poses within reach of the Border.
+			do
+			{
+				robot.setCenter(1079.0f * unit(random), 719.0f * unit(random));
+			}
+			while (excursion(robot) > 0.0f || excursion(robot) < -4.0f * SPEED * unit(random));
+
+			for (uint32_t step = 0; step < steps; step++)
+			{
+				robot.doSomething(keys[random() % (sizeof(keys) - 1)]);
+				worst = max(worst, excursion(robot));
+			}
+		}
+
+		bool passed = worst <= BORDER_TOLERANCE;
+		stream << left << setw(24) << (mode == Precision::FAST ? "border/fast" : "border/exact") << right << fixed << setprecision(6)
+		       << setw(12) << worst << " <= " << BORDER_TOLERANCE << (passed == true ? "  ok" : "  FAILED") << endl;
+		if (passed == false)
+		{
+			result = -1;
+		}
+	}
+
+	setPrecision(previous);
+
+	return result;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <ostream>
+
+#include "robot.h"
+
+#define BORDER_TOLERANCE 1e-3f
+
+enum class Precision
+{
+	EXACT,
+	FAST
+};
+
+// Process-wide precision of the Border rotation limits. EXACT calls libm per
+// boundary point and quadrant as before. FAST evaluates the simd.h polynomial
+// atan2/acos a lane batch of points at a time and shrinks every limit by their
+// error bounds. acos is ill-conditioned where a point barely reaches a wall,
+// so the only guarantee is that of validate(): it measures the polynomials
+// against double precision libm and drives robots along the Border in both
+// modes, failing if any boundary point ends up more than BORDER_TOLERANCE
+// outside.
+class FastMath
+{
+public:
+	static void setPrecision(const Precision precision);
+	static Precision precision();
+
+	static float rotationLimit(
+		const PolygonPoints& points,
+		const cv::Point2f origin,
+		const float distances[4],
+		const Rotation rotation,
+		const float limit
+	);
+
+	static int32_t validate(std::ostream& stream, const uint32_t poses = 1024, const uint32_t steps = 256);
+};
@@ -0,0 +1,24 @@
+#include "benchmark.h"
+#include "fast_math.h"
+
+using namespace std;
+using namespace cv;
+
+void benchmarkFastMath(Benchmark& benchmark)
+{
+	auto& robots = benchmark.robots();
+	auto previous = FastMath::precision();
+	FastMath::setPrecision(Precision::FAST);
+
+	benchmark.measure("Robot::calculateAngularDisplacement/fast", robots.size(), [&robots](size_t index)
+	{
+		return robots[index].calculateAngularDisplacement(static_cast<Rotation>(index % 2));
+	});
+
+	benchmark.measure("CombatModule::calculateAngularDisplacement/fast", robots.size(), [&robots](size_t index)
+	{
+		return robots[index].combatModule().calculateAngularDisplacement(static_cast<Rotation>(index % 2));
+	});
+
+	FastMath::setPrecision(previous);
+}
@@ -0,0 +1,228 @@
+#include "frame_recorder.h"
+#include "opencv2/imgcodecs.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+using namespace std;
+using namespace cv;
+
+FrameRecorder::FrameRecorder(
+	const std::string& path,
+	const RecorderFormat format,
+	const cv::Size2i size,
+	const double fps,
+	const size_t capacity,
+	const uint32_t encoders,
+	const OverflowPolicy policy
+) :
+	m_path(path),
+	m_format(format),
+	m_size(size),
+	m_fps(fps),
+	m_encoders(format == RecorderFormat::VIDEO ? 1 : max(encoders, 1u)),
+	m_policy(policy),
+	m_slots(max(capacity, static_cast<size_t>(1))),
+	m_free(m_slots.size()),
+	m_ready(m_slots.size()),
+	m_freeCount(m_slots.size()),
+	m_readyHead(0),
+	m_readyCount(0),
+	m_running(false),
+	m_stopping(false),
+	m_statistics({ 0, 0, 0, 0, 0.0 })
+{
+	for (size_t index = 0; index < m_slots.size(); index++)
+	{
+		m_slots[index].image.create(m_size, CV_8UC3);
+		m_slots[index].index = 0;
+		m_free[index] = index;
+	}
+}
+
+FrameRecorder::~FrameRecorder()
+{
+	stop();
+}
+
+int32_t FrameRecorder::start()
+{
+	if (m_running == true)
+	{
+		return 0;
+	}
+
+	if (m_format == RecorderFormat::VIDEO)
+	{
+		if (m_writer.open(m_path, VideoWriter::fourcc('M', 'J', 'P', 'G'), m_fps, m_size, true) == false)
+		{
+			return -1;
+		}
+	}
+
+	m_stopping = false;
+	m_running = true;
+
+	for (uint32_t index = 0; index < m_encoders; index++)
+	{
+		m_threads.push_back(thread(&FrameRecorder::encode, this));
+	}
+
+	return 0;
+}
+
+int32_t FrameRecorder::submit(const cv::Mat& frame, const uint64_t index)
+{
+	if (m_running == false || frame.size() != m_size || frame.type() != CV_8UC3)
+	{
+		return -1;
+	}
+
+	size_t slot;
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_statistics.submitted++;
+
+		if (m_freeCount == 0)
+		{
+			if (m_policy == OverflowPolicy::DROP)
+			{
+				m_statistics.dropped++;
+				return -2;
+			}
+
+			auto begin = chrono::steady_clock::now();
+			m_freeCondition.wait(lock, [this]() { return m_freeCount > 0; });
+			m_statistics.blockedSeconds += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		}
+
+		slot = m_free[--m_freeCount];
+	}
+
+	frame.copyTo(m_slots[slot].image);
+	m_slots[slot].index = index;
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_ready[(m_readyHead + m_readyCount) % m_ready.size()] = slot;
+		m_readyCount++;
+	}
+	m_readyCondition.notify_one();
+
+	return 0;
+}
+
+void FrameRecorder::stop()
+{
+	if (m_running == false)
+	{
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_readyCondition.notify_all();
+
+	for (auto& encoder : m_threads)
+	{
+		encoder.join();
+	}
+	m_threads.clear();
+
+	if (m_writer.isOpened() == true)
+	{
+		m_writer.release();
+	}
+
+	m_running = false;
+}
+
+bool FrameRecorder::running() const
+{
+	return m_running;
+}
+
+RecorderStatistics FrameRecorder::statistics() const
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_statistics;
+}
+
+std::string FrameRecorder::filename(const std::string& path, const RecorderFormat format, const uint64_t index)
+{
+	char number[32];
+	snprintf(number, sizeof(number), "%06llu", static_cast<unsigned long long>(index));
+
+	switch (format)
+	{
+	case RecorderFormat::PNG:
+		return path + number + ".png";
+	case RecorderFormat::RAW:
+		return path + number + ".raw";
+	default:
+		return path;
+	}
+}
+
+void FrameRecorder::encode()
+{
+	while (true)
+	{
+		size_t slot;
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_readyCondition.wait(lock, [this]() { return m_readyCount > 0 || m_stopping == true; });
+
+			if (m_readyCount == 0)
+			{
+				return;
+			}
+
+			slot = m_ready[m_readyHead];
+			m_readyHead = (m_readyHead + 1) % m_ready.size();
+			m_readyCount--;
+		}
+
+		bool written = write(m_slots[slot]);
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+			if (written == true)
+			{
+				m_statistics.written++;
+			}
+			else
+			{
+				m_statistics.failed++;
+			}
+			m_free[m_freeCount++] = slot;
+		}
+		m_freeCondition.notify_one();
+	}
+}
+
+bool FrameRecorder::write(const Slot& slot)
+{
+	switch (m_format)
+	{
+	case RecorderFormat::VIDEO:
+		m_writer.write(slot.image);
+		return true;
+	case RecorderFormat::PNG:
+		return imwrite(filename(m_path, m_format, slot.index), slot.image);
+	case RecorderFormat::RAW:
+	{
+		ofstream file(filename(m_path, m_format, slot.index), ios::binary);
+		for (int32_t row = 0; row < slot.image.rows && file.good() == true; row++)
+		{
+			file.write(reinterpret_cast<const char*>(slot.image.ptr<uint8_t>(row)), slot.image.cols * slot.image.elemSize());
+		}
+		return file.good();
+	}
+	default:
+		return false;
+	}
+}
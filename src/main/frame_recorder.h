@@ -0,0 +1,97 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "opencv2/core.hpp"
+#include "opencv2/videoio.hpp"
+
+enum class RecorderFormat
+{
+	VIDEO,
+	PNG,
+	RAW
+};
+
+enum class OverflowPolicy
+{
+	DROP,
+	BLOCK
+};
+
+struct RecorderStatistics
+{
+	uint64_t submitted;
+	uint64_t written;
+	uint64_t dropped;
+	uint64_t failed;
+	double blockedSeconds;
+};
+
+// Frames are copied into a fixed pool of pre-allocated slots and encoded by
+// background threads. A video file is written by a single encoder so frames
+// stay in order; PNG and raw sequences are named by frame index and use the
+// whole pool.
+class FrameRecorder
+{
+public:
+	FrameRecorder(
+		const std::string& path,
+		const RecorderFormat format,
+		const cv::Size2i size = cv::Size2i(1080, 720),
+		const double fps = 10.0,
+		const size_t capacity = 16,
+		const uint32_t encoders = 2,
+		const OverflowPolicy policy = OverflowPolicy::DROP
+	);
+	~FrameRecorder();
+
+	FrameRecorder(const FrameRecorder&) = delete;
+	FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+	int32_t start();
+	int32_t submit(const cv::Mat& frame, const uint64_t index);
+	void stop();
+
+	bool running() const;
+	RecorderStatistics statistics() const;
+
+	static std::string filename(const std::string& path, const RecorderFormat format, const uint64_t index);
+
+private:
+	struct Slot
+	{
+		cv::Mat image;
+		uint64_t index;
+	};
+
+	void encode();
+	bool write(const Slot& slot);
+
+	std::string m_path;
+	RecorderFormat m_format;
+	cv::Size2i m_size;
+	double m_fps;
+	uint32_t m_encoders;
+	OverflowPolicy m_policy;
+
+	std::vector<Slot> m_slots;
+	std::vector<size_t> m_free;
+	std::vector<size_t> m_ready;
+	size_t m_freeCount;
+	size_t m_readyHead;
+	size_t m_readyCount;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_readyCondition;
+	std::condition_variable m_freeCondition;
+	std::vector<std::thread> m_threads;
+	cv::VideoWriter m_writer;
+	bool m_running;
+	bool m_stopping;
+
+	RecorderStatistics m_statistics;
+};
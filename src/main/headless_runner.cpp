@@ -0,0 +1,214 @@
+#include "headless_runner.h"
+#include "profiler.h"
+
+#include <chrono>
+
+using namespace std;
+using namespace cv;
+
+HeadlessRunner::HeadlessRunner(
+	Robot& robot,
+	const float timestep,
+	const uint32_t renderInterval
+) :
+	m_robot(robot),
+	m_timestep(timestep),
+	m_renderInterval(renderInterval),
+	m_commandLog(nullptr),
+	m_renderer(robot.area()),
+	m_ticks(0),
+	m_executedTicks(0),
+	m_frames(0),
+	m_wallSeconds(0.0)
+{
+	m_renderer.add(robot);
+}
+
+void HeadlessRunner::setTimestep(const float timestep)
+{
+	m_timestep = timestep;
+}
+
+float HeadlessRunner::timestep() const
+{
+	return m_timestep;
+}
+
+void HeadlessRunner::setRenderInterval(const uint32_t renderInterval)
+{
+	m_renderInterval = renderInterval;
+}
+
+uint32_t HeadlessRunner::renderInterval() const
+{
+	return m_renderInterval;
+}
+
+void HeadlessRunner::setFrameCallback(std::function<void(const cv::Mat&, uint64_t)> callback)
+{
+	m_frameCallback = callback;
+}
+
+void HeadlessRunner::setCommandLog(CommandLogWriter* commandLog)
+{
+	m_commandLog = commandLog;
+}
+
+void HeadlessRunner::setTickCallback(std::function<void(uint64_t)> callback)
+{
+	m_tickCallback = callback;
+}
+
+int32_t HeadlessRunner::step(const char key)
+{
+	PROFILE_SCOPE("HeadlessRunner::step");
+
+	if (m_commandLog != nullptr && m_commandLog->append(m_ticks, key) != 0)
+	{
+		return -1;
+	}
+
+	{
+		PROFILE_SCOPE("Robot::doSomething");
+		m_robot.doSomething(key);
+	}
+	m_ticks++;
+	m_executedTicks++;
+
+	if (m_tickCallback)
+	{
+		m_tickCallback(m_ticks);
+	}
+
+	if (m_renderInterval == 0 || m_ticks % m_renderInterval != 0)
+	{
+		return 0;
+	}
+
+	m_renderer.setArea(m_robot.area());
+
+	if (m_renderer.render() != 0)
+	{
+		return -1;
+	}
+
+	if (m_renderer.changed() == true)
+	{
+		m_frames++;
+	}
+
+	if (m_frameCallback)
+	{
+		m_frameCallback(m_renderer.frame(), m_ticks);
+	}
+
+	return 0;
+}
+
+int32_t HeadlessRunner::run(std::istream& commands, const uint64_t maxTicks)
+{
+	auto start = chrono::steady_clock::now();
+	uint64_t ticks = 0;
+	int32_t result = 0;
+
+	char key;
+	while (ticks < maxTicks && commands.get(key))
+	{
+		if (key == '\n' || key == '\r')
+		{
+			continue;
+		}
+
+		if (step(key) != 0)
+		{
+			result = -1;
+			break;
+		}
+		ticks++;
+	}
+
+	auto finish = chrono::steady_clock::now();
+	m_wallSeconds += chrono::duration<double>(finish - start).count();
+
+	return result;
+}
+
+int32_t HeadlessRunner::replay(CommandLogReader& commandLog, const uint64_t maxCommands)
+{
+	auto start = chrono::steady_clock::now();
+	uint64_t resumed = m_ticks;
+	uint64_t commands = 0;
+	int32_t result = 0;
+
+	uint64_t tick;
+	char key;
+	while (commands < maxCommands)
+	{
+		result = commandLog.next(tick, key);
+		if (result != 0)
+		{
+			result = result == -1 ? 0 : -1;
+			break;
+		}
+
+		if (tick < resumed)
+		{
+			continue;
+		}
+
+		if (m_tickCallback && commands > 0 && tick >= m_ticks)
+		{
+			m_tickCallback(m_ticks);
+		}
+
+		m_robot.doSomething(key);
+		if (tick >= m_ticks)
+		{
+			m_executedTicks += tick + 1 - m_ticks;
+			m_ticks = tick + 1;
+		}
+		commands++;
+	}
+
+	auto finish = chrono::steady_clock::now();
+	m_wallSeconds += chrono::duration<double>(finish - start).count();
+
+	return result;
+}
+
+void HeadlessRunner::resume(const uint64_t ticks)
+{
+	m_ticks = ticks;
+	m_executedTicks = 0;
+	m_wallSeconds = 0.0;
+}
+
+uint64_t HeadlessRunner::ticks() const
+{
+	return m_ticks;
+}
+
+double HeadlessRunner::time() const
+{
+	return m_ticks * static_cast<double>(m_timestep);
+}
+
+const cv::Mat& HeadlessRunner::frame() const
+{
+	return m_renderer.frame();
+}
+
+RunnerStatistics HeadlessRunner::statistics() const
+{
+	RunnerStatistics statistics =
+	{
+		m_ticks,
+		m_executedTicks,
+		m_frames,
+		time(),
+		m_wallSeconds,
+		m_wallSeconds > 0.0 ? m_executedTicks / m_wallSeconds : 0.0
+	};
+
+	return statistics;
+}
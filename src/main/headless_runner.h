@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+#include <istream>
+
+#include "robot.h"
+#include "renderer.h"
+#include "command_log.h"
+
+// ticks is the absolute tick, including any resumed from a checkpoint;
+// executedTicks and ticksPerSecond only cover the ticks run since the runner
+// was created or last resumed.
+struct RunnerStatistics
+{
+	uint64_t ticks;
+	uint64_t executedTicks;
+	uint64_t frames;
+	double simulatedSeconds;
+	double wallSeconds;
+	double ticksPerSecond;
+};
+
+class HeadlessRunner
+{
+public:
+	HeadlessRunner(
+		Robot& robot,
+		const float timestep = 0.1f,
+		const uint32_t renderInterval = 0
+	);
+	~HeadlessRunner() = default;
+
+	void setTimestep(const float timestep);
+	float timestep() const;
+
+	void setRenderInterval(const uint32_t renderInterval);
+	uint32_t renderInterval() const;
+
+	void setFrameCallback(std::function<void(const cv::Mat&, uint64_t)> callback);
+	void setCommandLog(CommandLogWriter* commandLog);
+	void setTickCallback(std::function<void(uint64_t)> callback);
+
+	int32_t step(const char key);
+	int32_t run(std::istream& commands, const uint64_t maxTicks = UINT64_MAX);
+	int32_t replay(CommandLogReader& commandLog, const uint64_t maxCommands = UINT64_MAX);
+	void resume(const uint64_t ticks);
+
+	uint64_t ticks() const;
+	double time() const;
+	const cv::Mat& frame() const;
+	RunnerStatistics statistics() const;
+
+private:
+	Robot& m_robot;
+	float m_timestep;
+	uint32_t m_renderInterval;
+	std::function<void(const cv::Mat&, uint64_t)> m_frameCallback;
+	std::function<void(uint64_t)> m_tickCallback;
+	CommandLogWriter* m_commandLog;
+	Renderer m_renderer;
+	uint64_t m_ticks;
+	uint64_t m_executedTicks;
+	uint64_t m_frames;
+	double m_wallSeconds;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <initializer_list>
+
+#include "opencv2/core.hpp"
+
+#define POLYGON_CAPACITY 16
+
+template <size_t Capacity>
+class InlinePoints
+{
+public:
+	InlinePoints() :
+		m_size(0)
+	{
+
+	}
+
+	InlinePoints(std::initializer_list<cv::Point2f> points) :
+		m_size(0)
+	{
+		append(points.begin(), points.end());
+	}
+
+	int32_t append(const cv::Point2f point)
+	{
+		if (m_size == Capacity)
+		{
+			return -1;
+		}
+
+		m_points[m_size++] = point;
+		return 0;
+	}
+
+	template <typename Iterator>
+	int32_t append(Iterator begin, Iterator end)
+	{
+		for (auto iterator = begin; iterator != end; ++iterator)
+		{
+			if (append(*iterator) != 0)
+			{
+				return -1;
+			}
+		}
+
+		return 0;
+	}
+
+	void clear() { m_size = 0; }
+	void resize(const size_t size) { m_size = size < Capacity ? size : Capacity; }
+
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	static size_t capacity() { return Capacity; }
+
+	cv::Point2f* data() { return m_points; }
+	const cv::Point2f* data() const { return m_points; }
+
+	cv::Point2f* begin() { return m_points; }
+	cv::Point2f* end() { return m_points + m_size; }
+	const cv::Point2f* begin() const { return m_points; }
+	const cv::Point2f* end() const { return m_points + m_size; }
+
+	cv::Point2f& operator[](const size_t index) { return m_points[index]; }
+	const cv::Point2f& operator[](const size_t index) const { return m_points[index]; }
+
+	const cv::Point2f& front() const { return m_points[0]; }
+	const cv::Point2f& back() const { return m_points[m_size - 1]; }
+
+private:
+	cv::Point2f m_points[Capacity];
+	size_t m_size;
+};
+
+typedef InlinePoints<POLYGON_CAPACITY> PolygonPoints;
@@ -0,0 +1,526 @@
+#include "lidar.h"
+#include "profiler.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <random>
+
+using namespace std;
+using namespace cv;
+
+namespace
+{
+	// Every Border wall and footprint edge against one ray, in double.
+	double referenceRange(const Point2f origin, const double angle, const double range, const Border& border, const vector<WarRobot*>& robots, const WarRobot* self)
+	{
+		double dx = cos(angle);
+		double dy = sin(angle);
+
+		double toX = dx > 0.0 ? (border.right - origin.x) / dx : (dx < 0.0 ? (border.left - origin.x) / dx : range);
+		double toY = dy > 0.0 ? (border.top - origin.y) / dy : (dy < 0.0 ? (border.bottom - origin.y) / dy : range);
+		double result = max(min(range, min(toX, toY)), 0.0);
+
+		for (auto robot : robots)
+		{
+			if (robot == self)
+			{
+				continue;
+			}
+
+			auto footprint = robot->footprint();
+			for (size_t part = 0; part < footprint.size; part++)
+			{
+				auto& points = footprint.parts[part];
+				for (size_t index = 0; index < points.size(); index++)
+				{
+					auto& from = points[index];
+					auto& to = points[(index + 1) % points.size()];
+					double fromX = from.x - origin.x;
+					double fromY = from.y - origin.y;
+					double deltaX = to.x - from.x;
+					double deltaY = to.y - from.y;
+
+					double denominator = dx * deltaY - dy * deltaX;
+					if (denominator == 0.0)
+					{
+						continue;
+					}
+
+					double t = (fromX * deltaY - fromY * deltaX) / denominator;
+					double u = (fromX * dy - fromY * dx) / denominator;
+					if (t >= 0.0 && u >= 0.0 && u <= 1.0)
+					{
+						result = min(result, t);
+					}
+				}
+			}
+		}
+
+		return result;
+	}
+}
+
+Lidar::Lidar(
+	const uint32_t rays,
+	const float range,
+	const float fieldOfView,
+	const LidarMount mount
+) :
+	m_rays(min(max(rays, 1u), static_cast<uint32_t>(LIDAR_CAPACITY))),
+	m_range(range),
+	m_fieldOfView(min(max(fieldOfView, 0.0f), static_cast<float>(2.0 * M_PI))),
+	m_mount(mount),
+	m_offset(0.0f, 0.0f),
+	m_parallel(true)
+{
+	// A full circle spaces the rays so the last one does not repeat the first.
+	if (m_fieldOfView >= static_cast<float>(2.0 * M_PI) - 1e-4f)
+	{
+		m_start = 0.0f;
+		m_step = static_cast<float>(2.0 * M_PI) / m_rays;
+	}
+	else
+	{
+		m_start = m_rays > 1 ? -m_fieldOfView / 2.0f : 0.0f;
+		m_step = m_rays > 1 ? m_fieldOfView / (m_rays - 1) : 0.0f;
+	}
+
+	size_t padded = (m_rays + simd::LANES - 1) / simd::LANES * simd::LANES;
+	m_cosines.assign(padded, 1.0f);
+	m_sines.assign(padded, 0.0f);
+	for (size_t ray = 0; ray < m_rays; ray++)
+	{
+		m_cosines[ray] = static_cast<float>(cos(static_cast<double>(m_start) + static_cast<double>(m_step) * ray));
+		m_sines[ray] = static_cast<float>(sin(static_cast<double>(m_start) + static_cast<double>(m_step) * ray));
+	}
+}
+
+uint32_t Lidar::rays() const
+{
+	return m_rays;
+}
+
+float Lidar::range() const
+{
+	return m_range;
+}
+
+float Lidar::fieldOfView() const
+{
+	return m_fieldOfView;
+}
+
+float Lidar::rayAngle(size_t ray) const
+{
+	return m_start + m_step * ray;
+}
+
+void Lidar::setMount(const LidarMount mount)
+{
+	m_mount = mount;
+}
+
+LidarMount Lidar::mount() const
+{
+	return m_mount;
+}
+
+void Lidar::setOffset(const cv::Point2f offset)
+{
+	m_offset = offset;
+}
+
+cv::Point2f Lidar::offset() const
+{
+	return m_offset;
+}
+
+void Lidar::setParallel(const bool parallel)
+{
+	m_parallel = parallel;
+}
+
+bool Lidar::parallel() const
+{
+	return m_parallel;
+}
+
+void Lidar::pose(WarRobot& robot, cv::Point2f& origin, float& heading) const
+{
+	if (m_mount == LidarMount::TURRET)
+	{
+		Point2f muzzle;
+		Point2f direction;
+		robot.muzzle(muzzle, direction);
+		heading = atan2f(direction.y, direction.x);
+		origin = robot.turretCenter();
+	}
+	else
+	{
+		heading = robot.angle();
+		origin = robot.center();
+	}
+
+	float cosine = cosf(heading);
+	float sine = sinf(heading);
+	origin = origin + Point2f(m_offset.x * cosine - m_offset.y * sine, m_offset.x * sine + m_offset.y * cosine);
+}
+
+int32_t Lidar::scan(WarRobot& robot, const std::vector<Robot*>& robots, float* ranges)
+{
+	if (ranges == nullptr)
+	{
+		return -1;
+	}
+
+	PROFILE_SCOPE("Lidar::scan");
+
+	capture(robots);
+
+	Point2f origin;
+	float heading;
+	pose(robot, origin, heading);
+	cast(origin, heading, robot.border(), &robot, ranges);
+
+	return 0;
+}
+
+int32_t Lidar::scan(const std::vector<WarRobot*>& robots, float* ranges)
+{
+	if (ranges == nullptr)
+	{
+		return -1;
+	}
+
+	PROFILE_SCOPE("Lidar::scanFleet");
+
+	capture(robots);
+
+	auto scanRange = [this, &robots, ranges](const Range& range)
+	{
+		for (int32_t index = range.start; index < range.end; index++)
+		{
+			auto& robot = *robots[index];
+			Point2f origin;
+			float heading;
+			pose(robot, origin, heading);
+			cast(origin, heading, robot.border(), &robot, ranges + static_cast<size_t>(index) * m_rays);
+		}
+	};
+
+	if (m_parallel == true)
+	{
+		parallel_for_(Range(0, static_cast<int32_t>(robots.size())), scanRange);
+	}
+	else
+	{
+		scanRange(Range(0, static_cast<int32_t>(robots.size())));
+	}
+
+	return 0;
+}
+
+void Lidar::capture(const std::vector<Robot*>& robots)
+{
+	clearObstacles();
+
+	for (auto robot : robots)
+	{
+		addObstacle(*robot);
+	}
+}
+
+void Lidar::capture(const std::vector<WarRobot*>& robots)
+{
+	clearObstacles();
+
+	for (auto robot : robots)
+	{
+		addObstacle(*robot);
+	}
+}
+
+void Lidar::clearObstacles()
+{
+	m_obstacles.clear();
+	m_centers.clear();
+	m_radii.clear();
+	m_partBegin.assign(1, 0);
+	m_partCenters.clear();
+	m_partRadii.clear();
+	m_edgeFrom.clear();
+	m_edgeDelta.clear();
+	m_edgeBegin.assign(1, 0);
+}
+
+void Lidar::addObstacle(Robot& robot)
+{
+	auto footprint = robot.footprint();
+	auto robotCenter = robot.center();
+	float robotRadius = 0.0f;
+
+	// Every convex part also gets its own, much tighter, bounding circle for
+	// origins inside the circle around the whole robot and its gun.
+	for (size_t part = 0; part < footprint.size; part++)
+	{
+		auto& points = footprint.parts[part];
+		if (points.empty() == true)
+		{
+			continue;
+		}
+
+		Point2f center(0.0f, 0.0f);
+		for (auto& point : points)
+		{
+			center = center + point;
+		}
+		center = center * (1.0f / points.size());
+
+		float radius = 0.0f;
+		for (size_t index = 0; index < points.size(); index++)
+		{
+			auto& from = points[index];
+			auto& to = points[(index + 1) % points.size()];
+			m_edgeFrom.push_back(from);
+			m_edgeDelta.push_back(to - from);
+			radius = max(radius, hypotf(from.x - center.x, from.y - center.y));
+			robotRadius = max(robotRadius, hypotf(from.x - robotCenter.x, from.y - robotCenter.y));
+		}
+
+		m_partCenters.push_back(center);
+		m_partRadii.push_back(radius);
+		m_edgeBegin.push_back(static_cast<uint32_t>(m_edgeFrom.size()));
+	}
+
+	m_obstacles.push_back(&robot);
+	m_centers.push_back(robotCenter);
+	m_radii.push_back(robotRadius);
+	m_partBegin.push_back(static_cast<uint32_t>(m_partCenters.size()));
+}
+
+void Lidar::cast(const cv::Point2f origin, const float heading, const Border& border, const Robot* self, float* ranges) const
+{
+	float directionX[LIDAR_CAPACITY + simd::LANES];
+	float directionY[LIDAR_CAPACITY + simd::LANES];
+	float result[LIDAR_CAPACITY + simd::LANES];
+
+	size_t padded = m_cosines.size();
+	const simd::Lane cosine = simd::set(cosf(heading));
+	const simd::Lane sine = simd::set(sinf(heading));
+	const simd::Lane originX = simd::set(origin.x);
+	const simd::Lane originY = simd::set(origin.y);
+	const simd::Lane zero = simd::set(0.0f);
+	const simd::Lane one = simd::set(1.0f);
+
+	// Border: the nearer of the two walls each ray heads towards; a ray along
+	// an axis divides by zero into +inf on one side and -inf on the other.
+	for (size_t ray = 0; ray < padded; ray += simd::LANES)
+	{
+		simd::Lane localX = simd::load(m_cosines.data() + ray);
+		simd::Lane localY = simd::load(m_sines.data() + ray);
+		simd::Lane x = simd::sub(simd::mul(localX, cosine), simd::mul(localY, sine));
+		simd::Lane y = simd::add(simd::mul(localX, sine), simd::mul(localY, cosine));
+		simd::store(directionX + ray, x);
+		simd::store(directionY + ray, y);
+
+		simd::Lane toX = simd::max(
+			simd::div(simd::sub(simd::set(border.right), originX), x),
+			simd::div(simd::sub(simd::set(border.left), originX), x)
+		);
+		simd::Lane toY = simd::max(
+			simd::div(simd::sub(simd::set(border.top), originY), y),
+			simd::div(simd::sub(simd::set(border.bottom), originY), y)
+		);
+		simd::Lane range = simd::min(simd::set(m_range), simd::min(toX, toY));
+		simd::store(result + ray, simd::max(range, zero));
+	}
+
+	// Batches starting inside an interval may run past the padded rays.
+	fill(directionX + padded, directionX + padded + simd::LANES, 1.0f);
+	fill(directionY + padded, directionY + padded + simd::LANES, 0.0f);
+	fill(result + padded, result + padded + simd::LANES, 0.0f);
+
+	auto trace = [&](const Point2f center, const float radius, const uint32_t edgeBegin, const uint32_t edgeEnd)
+	{
+		auto offset = center - origin;
+		float distance = hypotf(offset.x, offset.y);
+
+		// Ray index intervals covering the bounding circle, the second one for
+		// the part that wraps past a full turn.
+		int64_t intervals[2][2] = { { 0, static_cast<int64_t>(m_rays) - 1 }, { 1, 0 } };
+		if (distance > radius)
+		{
+			float alpha = asinf(radius / distance);
+			float low = atan2f(offset.y, offset.x) - heading - alpha - m_start;
+			low -= static_cast<float>(2.0 * M_PI) * floorf(low / static_cast<float>(2.0 * M_PI));
+
+			for (size_t turn = 0; turn < 2; turn++)
+			{
+				float from = low - static_cast<float>(2.0 * M_PI) * turn;
+				float to = from + 2.0f * alpha;
+				if (m_step > 0.0f)
+				{
+					intervals[turn][0] = max<int64_t>(static_cast<int64_t>(ceilf(from / m_step)), 0);
+					intervals[turn][1] = min<int64_t>(static_cast<int64_t>(floorf(to / m_step)), m_rays - 1);
+				}
+				else
+				{
+					intervals[turn][0] = 0;
+					intervals[turn][1] = from <= 0.0f && to >= 0.0f ? 0 : -1;
+				}
+			}
+		}
+
+		// Batches whose rays all stop short of the bounding circle are hidden.
+		const simd::Lane nearest = simd::set(distance - radius);
+
+		for (auto& interval : intervals)
+		{
+			for (int64_t ray = interval[0]; ray <= interval[1]; ray += simd::LANES)
+			{
+				simd::Lane range = simd::load(result + ray);
+				if (simd::bits(simd::greater(range, nearest)) == 0)
+				{
+					continue;
+				}
+
+				simd::Lane x = simd::load(directionX + ray);
+				simd::Lane y = simd::load(directionY + ray);
+
+				for (uint32_t edge = edgeBegin; edge < edgeEnd; edge++)
+				{
+					auto from = m_edgeFrom[edge] - origin;
+					auto& delta = m_edgeDelta[edge];
+
+					// origin + t * direction = from + u * delta
+					simd::Lane inverse = simd::div(one, simd::sub(simd::mul(x, simd::set(delta.y)), simd::mul(y, simd::set(delta.x))));
+					simd::Lane t = simd::mul(simd::set(from.x * delta.y - from.y * delta.x), inverse);
+					simd::Lane u = simd::mul(simd::sub(simd::mul(simd::set(from.x), y), simd::mul(simd::set(from.y), x)), inverse);
+					simd::Mask hit = simd::both(simd::both(simd::greaterEqual(t, zero), simd::greaterEqual(u, zero)), simd::lessEqual(u, one));
+					range = simd::select(hit, simd::min(range, t), range);
+				}
+
+				simd::store(result + ray, range);
+			}
+		}
+	};
+
+	for (size_t obstacle = 0; obstacle < m_obstacles.size(); obstacle++)
+	{
+		if (m_obstacles[obstacle] == self)
+		{
+			continue;
+		}
+
+		auto offset = m_centers[obstacle] - origin;
+		float distance = hypotf(offset.x, offset.y);
+		float radius = m_radii[obstacle];
+		if (distance - radius >= m_range)
+		{
+			continue;
+		}
+
+		uint32_t partBegin = m_partBegin[obstacle];
+		uint32_t partEnd = m_partBegin[obstacle + 1];
+		if (distance > radius)
+		{
+			trace(m_centers[obstacle], radius, m_edgeBegin[partBegin], m_edgeBegin[partEnd]);
+			continue;
+		}
+
+		for (uint32_t part = partBegin; part < partEnd; part++)
+		{
+			trace(m_partCenters[part], m_partRadii[part], m_edgeBegin[part], m_edgeBegin[part + 1]);
+		}
+	}
+
+	copy(result, result + m_rays, ranges);
+}
+
+int32_t Lidar::validate(std::ostream& stream, const uint32_t robots)
+{
+	int32_t result = 0;
+
+	mt19937 random(3);
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	vector<WarRobot> fleet;
+	fleet.reserve(robots);
+	for (uint32_t index = 0; index < robots; index++)
+	{
+		auto robot = WarRobot();
+		robot.setAngle(static_cast<float>(2.0 * M_PI) * unit(random));
+		robot.combatModule().setAngle(static_cast<float>(2.0 * M_PI) * unit(random));
+		robot.setCenter(50.0f + 980.0f * unit(random), 50.0f + 620.0f * unit(random));
+		fleet.push_back(robot);
+	}
+
+	vector<WarRobot*> pointers;
+	for (auto& robot : fleet)
+	{
+		pointers.push_back(&robot);
+	}
+
+	const struct
+	{
+		const char* name;
+		uint32_t rays;
+		float range;
+		float fieldOfView;
+		LidarMount mount;
+		Point2f offset;
+	}
+	checks[] =
+	{
+		{ "lidar/full", 360, LIDAR_RANGE, static_cast<float>(2.0 * M_PI), LidarMount::CHASSIS, Point2f(0.0f, 0.0f) },
+		{ "lidar/full/offset", 360, 300.0f, static_cast<float>(2.0 * M_PI), LidarMount::CHASSIS, Point2f(30.0f, 5.0f) },
+		{ "lidar/partial", 97, LIDAR_RANGE, 2.0f, LidarMount::TURRET, Point2f(0.0f, 0.0f) },
+		{ "lidar/partial/wrap", 181, LIDAR_RANGE, 4.0f, LidarMount::CHASSIS, Point2f(0.0f, 0.0f) }
+	};
+
+	for (auto& check : checks)
+	{
+		Lidar lidar(check.rays, check.range, check.fieldOfView, check.mount);
+		lidar.setOffset(check.offset);
+		lidar.setParallel(false);
+
+		// A robot straddling the first ray of the first scanner makes its ray
+		// interval wrap past a full turn.
+		if (robots > 1)
+		{
+			Point2f origin;
+			float heading;
+			lidar.pose(fleet[0], origin, heading);
+			float angle = heading + lidar.rayAngle(0);
+			fleet[1].setCenter(origin.x + 200.0f * cosf(angle), origin.y + 200.0f * sinf(angle));
+		}
+
+		vector<float> ranges(static_cast<size_t>(robots) * lidar.rays());
+		lidar.scan(pointers, ranges.data());
+
+		double worst = 0.0;
+		for (size_t index = 0; index < fleet.size(); index++)
+		{
+			Point2f origin;
+			float heading;
+			lidar.pose(fleet[index], origin, heading);
+
+			for (uint32_t ray = 0; ray < lidar.rays(); ray++)
+			{
+				double reference = referenceRange(origin, static_cast<double>(heading) + lidar.rayAngle(ray), lidar.range(), fleet[index].border(), pointers, &fleet[index]);
+				worst = max(worst, fabs(reference - ranges[index * lidar.rays() + ray]));
+			}
+		}
+
+		bool passed = worst <= LIDAR_TOLERANCE;
+		stream << left << setw(24) << check.name << right << fixed << setprecision(6)
+		       << setw(12) << worst << " <= " << LIDAR_TOLERANCE << (passed == true ? "  ok" : "  FAILED") << endl;
+		if (passed == false)
+		{
+			result = -1;
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include "war_robot.h"
+
+#define LIDAR_CAPACITY 2048
+#define LIDAR_RAYS 360
+#define LIDAR_RANGE 1000.0f
+#define LIDAR_TOLERANCE 1e-2f
+
+enum class LidarMount
+{
+	CHASSIS,
+	TURRET
+};
+
+// 2D scanning range finder. Rays fan out evenly over the field of view from
+// the chassis center or the turret, turned with it, plus an offset in the
+// mount frame. Each scan first clips every ray against the Border in closed
+// form, then tests the edges of every footprint part of the other robots
+// only against the rays inside the angle its bounding circle subtends, a lane
+// batch of rays per edge, skipping batches that already stop short of it.
+// Scans of a whole fleet share one snapshot of the footprints and run in
+// parallel.
+//
+// validate() compares full, partial and wrapping fields of view against a
+// brute-force double precision caster, failing past LIDAR_TOLERANCE.
+class Lidar
+{
+public:
+	Lidar(
+		const uint32_t rays = LIDAR_RAYS,
+		const float range = LIDAR_RANGE,
+		const float fieldOfView = static_cast<float>(2.0 * M_PI),
+		const LidarMount mount = LidarMount::CHASSIS
+	);
+	~Lidar() = default;
+
+	uint32_t rays() const;
+	float range() const;
+	float fieldOfView() const;
+	float rayAngle(size_t ray) const;
+
+	void setMount(const LidarMount mount);
+	LidarMount mount() const;
+	void setOffset(const cv::Point2f offset);
+	cv::Point2f offset() const;
+	void setParallel(const bool parallel);
+	bool parallel() const;
+
+	void pose(WarRobot& robot, cv::Point2f& origin, float& heading) const;
+
+	int32_t scan(WarRobot& robot, const std::vector<Robot*>& robots, float* ranges);
+	int32_t scan(const std::vector<WarRobot*>& robots, float* ranges);
+
+	static int32_t validate(std::ostream& stream, const uint32_t robots = 40);
+
+private:
+	void capture(const std::vector<Robot*>& robots);
+	void capture(const std::vector<WarRobot*>& robots);
+	void clearObstacles();
+	void addObstacle(Robot& robot);
+	void cast(const cv::Point2f origin, const float heading, const Border& border, const Robot* self, float* ranges) const;
+
+	uint32_t m_rays;
+	float m_range;
+	float m_fieldOfView;
+	float m_start;
+	float m_step;
+	LidarMount m_mount;
+	cv::Point2f m_offset;
+	bool m_parallel;
+	std::vector<float> m_cosines;
+	std::vector<float> m_sines;
+
+	std::vector<const Robot*> m_obstacles;
+	std::vector<cv::Point2f> m_centers;
+	std::vector<float> m_radii;
+	std::vector<uint32_t> m_partBegin;
+	std::vector<cv::Point2f> m_partCenters;
+	std::vector<float> m_partRadii;
+	std::vector<uint32_t> m_edgeBegin;
+	std::vector<cv::Point2f> m_edgeFrom;
+	std::vector<cv::Point2f> m_edgeDelta;
+};
@@ -0,0 +1,27 @@
+#include "benchmark.h"
+#include "lidar.h"
+
+using namespace std;
+using namespace cv;
+
+void benchmarkLidar(Benchmark& benchmark)
+{
+	vector<WarRobot*> scanners;
+	for (auto& robot : benchmark.robots())
+	{
+		scanners.push_back(&robot);
+	}
+
+	for (auto parallel : { false, true })
+	{
+		Lidar lidar(LIDAR_RAYS);
+		lidar.setParallel(parallel);
+		vector<float> ranges(scanners.size() * lidar.rays());
+
+		benchmark.measure(parallel == true ? "Lidar::scan/parallel" : "Lidar::scan/serial", 1, [&lidar, &scanners, &ranges](size_t)
+		{
+			lidar.scan(scanners, ranges.data());
+			return ranges[0];
+		}, scanners.size());
+	}
+}
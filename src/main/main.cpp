@@ -1,18 +1,360 @@
 ﻿#include <iostream>
-#include <windows.h>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
 
 #include "opencv2/core.hpp"
 #include "opencv2/highgui.hpp"
+#include "opencv2/imgcodecs.hpp"
+#include "opencv2/imgproc.hpp"
 #include "robot.h"
 #include "war_robot.h"
-
-#define sleep Sleep
+#include "headless_runner.h"
+#include "benchmark.h"
+#include "renderer.h"
+#include "obstacle_map.h"
+#include "frame_recorder.h"
+#include "simulation.h"
+#include "world_state.h"
+#include "profiler.h"
+#include "fast_math.h"
+#include "event_integrator.h"
+#include "lidar.h"
 
 using namespace std;
 using namespace cv;
 
-int main()
+unique_ptr<FrameRecorder> recorder(int argc, char** argv, const Size size, const double fps)
+{
+    string path;
+    auto format = RecorderFormat::VIDEO;
+    auto policy = OverflowPolicy::DROP;
+    uint32_t encoders = 2;
+
+    for (int index = 1; index + 1 < argc; index++)
+    {
+        string argument = argv[index];
+        string value = argv[index + 1];
+        if (argument == "--record")
+        {
+            path = value;
+        }
+        else if (argument == "--record-format")
+        {
+            format = value == "png" ? RecorderFormat::PNG : value == "raw" ? RecorderFormat::RAW : RecorderFormat::VIDEO;
+        }
+        else if (argument == "--record-policy")
+        {
+            policy = value == "block" ? OverflowPolicy::BLOCK : OverflowPolicy::DROP;
+        }
+        else if (argument == "--record-encoders")
+        {
+            encoders = static_cast<uint32_t>(stoul(value));
+        }
+    }
+
+    if (path.empty() == true)
+    {
+        return nullptr;
+    }
+
+    auto result = unique_ptr<FrameRecorder>(new FrameRecorder(path, format, size, fps, 16, encoders, policy));
+    if (result->start() != 0)
+    {
+        cerr << "Cannot record to " << path << endl;
+        return nullptr;
+    }
+
+    return result;
+}
+
+void printRecorder(const FrameRecorder* frameRecorder)
+{
+    if (frameRecorder == nullptr)
+    {
+        return;
+    }
+
+    auto statistics = frameRecorder->statistics();
+    cout << "recorded frames: " << statistics.written << endl;
+    cout << "dropped frames: " << statistics.dropped << endl;
+    cout << "failed frames: " << statistics.failed << endl;
+    cout << "blocked seconds: " << statistics.blockedSeconds << endl;
+}
+
+void writeProfile(int argc, char** argv)
+{
+    for (int index = 1; index + 1 < argc; index++)
+    {
+        string argument = argv[index];
+        if (argument != "--profile-csv" && argument != "--profile-trace")
+        {
+            continue;
+        }
+
+        if (Profiler::enabled() == false)
+        {
+            cerr << "Built without ROBOT_PROFILE, " << argument << " ignored" << endl;
+            continue;
+        }
+
+        ofstream file(argv[index + 1]);
+        if (file.is_open() == false)
+        {
+            cerr << "Cannot write " << argv[index + 1] << endl;
+            continue;
+        }
+
+        if (argument == "--profile-csv")
+        {
+            Profiler::writeCsv(file);
+        }
+        else
+        {
+            Profiler::writeTrace(file);
+        }
+    }
+}
+
+int headless(WarRobot& robot, int argc, char** argv)
+{
+    string commands = "-";
+    string replay;
+    string log;
+    string checkpoint;
+    string resume;
+    double checkpointSeconds = 5.0;
+    float timestep = 0.1f;
+    uint32_t renderInterval = 0;
+
+    for (int index = 2; index < argc; index++)
+    {
+        string argument = argv[index];
+        if (argument == "--replay" && index + 1 < argc)
+        {
+            replay = argv[++index];
+        }
+        else if (argument == "--log" && index + 1 < argc)
+        {
+            log = argv[++index];
+        }
+        else if (argument == "--checkpoint" && index + 1 < argc)
+        {
+            checkpoint = argv[++index];
+        }
+        else if (argument == "--checkpoint-seconds" && index + 1 < argc)
+        {
+            checkpointSeconds = stod(argv[++index]);
+        }
+        else if (argument == "--resume" && index + 1 < argc)
+        {
+            resume = argv[++index];
+        }
+        else if (argument == "--render-every" && index + 1 < argc)
+        {
+            renderInterval = static_cast<uint32_t>(stoul(argv[++index]));
+        }
+        else if (argument == "--timestep" && index + 1 < argc)
+        {
+            timestep = stof(argv[++index]);
+        }
+        else if (argument == "--fast-math")
+        {
+            continue;
+        }
+        else if (argument.compare(0, 2, "--") == 0 && index + 1 < argc)
+        {
+            index++;
+        }
+        else
+        {
+            commands = argument;
+        }
+    }
+
+    auto runner = HeadlessRunner(robot, timestep, renderInterval);
+
+    auto frameRecorder = recorder(argc, argv, robot.area(), 1.0 / timestep);
+    if (frameRecorder != nullptr)
+    {
+        auto target = frameRecorder.get();
+        runner.setFrameCallback([target](const Mat& frame, uint64_t tick)
+        {
+            target->submit(frame, tick);
+        });
+    }
+
+    vector<Robot*> world = { &robot };
+    WorldState worldState;
+
+    if (resume.empty() == false)
+    {
+        if (worldState.load(resume) != 0 || worldState.restore(world) != 0)
+        {
+            cerr << "Cannot resume from " << resume << endl;
+            return -1;
+        }
+        runner.resume(worldState.tick());
+    }
+
+    if (checkpoint.empty() == false)
+    {
+        auto last = chrono::steady_clock::now();
+        runner.setTickCallback([&worldState, &world, &last, checkpoint, checkpointSeconds](uint64_t tick)
+        {
+            if (tick % 1024 != 0)
+            {
+                return;
+            }
+
+            auto now = chrono::steady_clock::now();
+            if (chrono::duration<double>(now - last).count() < checkpointSeconds)
+            {
+                return;
+            }
+            last = now;
+
+            if (worldState.capture(world, tick) != 0 || worldState.save(checkpoint) != 0)
+            {
+                cerr << "Cannot write checkpoint " << checkpoint << endl;
+            }
+        });
+    }
+
+    CommandLogWriter commandLog;
+    if (log.empty() == false)
+    {
+        if (commandLog.open(log) != 0)
+        {
+            cerr << "Cannot write " << log << endl;
+            return -1;
+        }
+        runner.setCommandLog(&commandLog);
+    }
+
+    if (replay.empty() == false)
+    {
+        CommandLogReader reader;
+        if (reader.open(replay) != 0)
+        {
+            cerr << "Cannot replay " << replay << endl;
+            return -1;
+        }
+        if (runner.replay(reader) != 0)
+        {
+            cerr << "Corrupt command log " << replay << endl;
+        }
+    }
+    else if (commands == "-")
+    {
+        runner.run(cin);
+    }
+    else
+    {
+        ifstream file(commands, ios::binary);
+        if (file.is_open() == false)
+        {
+            cerr << "Cannot open " << commands << endl;
+            return -1;
+        }
+
+        char key;
+        for (uint64_t skipped = 0; skipped < runner.ticks() && file.get(key);)
+        {
+            if (key != '\n' && key != '\r')
+            {
+                skipped++;
+            }
+        }
+
+        runner.run(file);
+    }
+
+    commandLog.close();
+
+    auto statistics = runner.statistics();
+    cout << "ticks: " << statistics.ticks << endl;
+    cout << "executed ticks: " << statistics.executedTicks << endl;
+    cout << "frames: " << statistics.frames << endl;
+    cout << "simulated seconds: " << statistics.simulatedSeconds << endl;
+    cout << "wall seconds: " << statistics.wallSeconds << endl;
+    cout << "ticks per second: " << statistics.ticksPerSecond << endl;
+    cout << "center: " << robot.center().x << " " << robot.center().y << endl;
+    cout << "angle: " << robot.angle() << endl;
+
+    if (frameRecorder != nullptr)
+    {
+        frameRecorder->stop();
+        printRecorder(frameRecorder.get());
+    }
+
+    writeProfile(argc, argv);
+
+    return 0;
+}
+
+int benchmark(int argc, char** argv)
 {
+    bool json = false;
+    double seconds = 0.2;
+
+    for (int index = 2; index < argc; index++)
+    {
+        string argument = argv[index];
+        if (argument == "--json")
+        {
+            json = true;
+        }
+        else if (argument == "--seconds" && index + 1 < argc)
+        {
+            seconds = stod(argv[++index]);
+        }
+    }
+
+    auto results = Benchmark(1024, seconds).run();
+
+    if (json == true)
+    {
+        Benchmark::printJson(cout, results);
+    }
+    else
+    {
+        Benchmark::print(cout, results);
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && string(argv[1]) == "--check-precision")
+    {
+        int32_t result = FastMath::validate(cout);
+        result = Renderer::validate(cout) != 0 ? -1 : result;
+        result = EventIntegrator::validate(cout) != 0 ? -1 : result;
+        result = Lidar::validate(cout) != 0 ? -1 : result;
+        return result;
+    }
+
+    if (argc > 1 && string(argv[1]) == "--check-allocations")
+    {
+        return Benchmark().checkAllocations(cout);
+    }
+
+    for (int index = 1; index < argc; index++)
+    {
+        if (string(argv[index]) == "--fast-math")
+        {
+            FastMath::setPrecision(Precision::FAST);
+        }
+    }
+
+    if (argc > 1 && string(argv[1]) == "--bench")
+    {
+        return benchmark(argc, argv);
+    }
+
     float width = 60;
     float lenght = 120;
     Wheel wheel = {10, 40};
@@ -29,17 +371,97 @@ int main()
     robot.setArea(area);
     robot.setCenter(area);
 
-    while (waitKey(1) != 27)
+    auto obstacles = ObstacleMap();
+    auto background = Mat();
+
+    for (int index = 1; index + 1 < argc; index++)
     {
-        char key = waitKey(100);
-        auto areaWithRobot = Mat(size, CV_8UC3, white);
+        if (string(argv[index]) == "--obstacles")
+        {
+            background = imread(argv[index + 1], IMREAD_COLOR);
+            if (obstacles.load(background) != 0)
+            {
+                cerr << "Cannot load obstacles from " << argv[index + 1] << endl;
+                return -1;
+            }
+            robot.setObstacles(&obstacles);
+        }
+    }
 
-        robot.doSomething(key);
-        robot.draw(areaWithRobot);
+    if (argc > 1 && string(argv[1]) == "--headless")
+    {
+        return headless(robot, argc, argv);
+    }
+
+    auto view = robot;
+    auto renderer = Renderer(size, white);
+    renderer.setBackground(background);
+    renderer.add(view);
+
+    auto frameRecorder = recorder(argc, argv, size, 10.0);
 
-        imshow("War Robot", areaWithRobot);
-        area = areaWithRobot;
+    Simulation simulation(robot, 0.1);
+
+    CommandLogWriter commandLog;
+    for (int index = 1; index + 1 < argc; index++)
+    {
+        if (string(argv[index]) == "--log" && commandLog.open(argv[index + 1]) == 0)
+        {
+            simulation.setCommandLog(&commandLog);
+        }
     }
 
+    simulation.start();
+
+    while (true)
+    {
+        int key;
+        {
+            PROFILE_SCOPE("input");
+            key = waitKey(15);
+        }
+
+        if (key == 27)
+        {
+            break;
+        }
+
+        if (key >= 0)
+        {
+            simulation.post(static_cast<char>(key));
+        }
+
+        if (simulation.update() == false)
+        {
+            continue;
+        }
+
+        Simulation::apply(simulation.snapshot(), view);
+        renderer.render();
+
+        if (renderer.changed() == true)
+        {
+            PROFILE_SCOPE("imshow");
+            imshow("War Robot", renderer.frame());
+        }
+
+        if (frameRecorder != nullptr)
+        {
+            PROFILE_SCOPE("FrameRecorder::submit");
+            frameRecorder->submit(renderer.frame(), simulation.snapshot().tick);
+        }
+    }
+
+    simulation.stop();
+    commandLog.close();
+
+    if (frameRecorder != nullptr)
+    {
+        frameRecorder->stop();
+        printRecorder(frameRecorder.get());
+    }
+
+    writeProfile(argc, argv);
+
     return 0;
 }
@@ -0,0 +1,355 @@
+#include "obstacle_map.h"
+#include "opencv2/imgproc.hpp"
+
+#define ITERATIONS 8
+#define EPSILON 0.001f
+
+using namespace std;
+using namespace cv;
+
+ObstacleMap::ObstacleMap(const float resolution, const float spacing) :
+	m_resolution(resolution > 0.0f && resolution < FLT_MAX ? resolution : 1.0f),
+	m_spacing(spacing > 0.0f ? spacing : SAMPLE_SPACING)
+{
+
+}
+
+int32_t ObstacleMap::load(const cv::Mat& image)
+{
+	if (image.empty() == true)
+	{
+		return -1;
+	}
+
+	Mat gray = image;
+	if (image.channels() == 3)
+	{
+		cvtColor(image, gray, COLOR_BGR2GRAY);
+	}
+	else if (image.channels() != 1)
+	{
+		return -2;
+	}
+
+	auto size = Size(cvCeil(image.cols / m_resolution), cvCeil(image.rows / m_resolution));
+	if (size != image.size())
+	{
+		resize(gray, gray, size, 0.0, 0.0, INTER_AREA);
+	}
+
+	Mat mask;
+	threshold(gray, mask, 0x7F, 0xFF, THRESH_BINARY_INV);
+	flip(mask, mask, 0);
+
+	build(mask);
+
+	return 0;
+}
+
+int32_t ObstacleMap::load(const std::vector<PolygonPoints>& polygons, const cv::Size2i area)
+{
+	if (area.width <= 0 || area.height <= 0)
+	{
+		return -1;
+	}
+
+	auto size = Size(cvCeil(area.width / m_resolution), cvCeil(area.height / m_resolution));
+	auto mask = Mat(size, CV_8UC1, Scalar(0));
+
+	vector<vector<Point>> contours;
+	for (auto& polygon : polygons)
+	{
+		vector<Point> contour;
+		for (auto& point : polygon)
+		{
+			contour.push_back(Point(cvRound(point.x / m_resolution), cvRound(point.y / m_resolution)));
+		}
+		contours.push_back(contour);
+	}
+	fillPoly(mask, contours, Scalar(0xFF));
+
+	build(mask);
+
+	return 0;
+}
+
+void ObstacleMap::clear()
+{
+	m_field = Mat();
+}
+
+bool ObstacleMap::empty() const
+{
+	return m_field.empty();
+}
+
+float ObstacleMap::resolution() const
+{
+	return m_resolution;
+}
+
+float ObstacleMap::spacing() const
+{
+	return m_spacing;
+}
+
+cv::Size2i ObstacleMap::size() const
+{
+	return m_field.size();
+}
+
+const cv::Mat& ObstacleMap::field() const
+{
+	return m_field;
+}
+
+float ObstacleMap::distance(const cv::Point2f point) const
+{
+	if (m_field.empty() == true)
+	{
+		return FLT_MAX;
+	}
+
+	float x = min(max(point.x / m_resolution - 0.5f, 0.0f), static_cast<float>(m_field.cols - 1));
+	float y = min(max(point.y / m_resolution - 0.5f, 0.0f), static_cast<float>(m_field.rows - 1));
+
+	// A field one cell wide or tall has nothing to interpolate against on that
+	// axis, so the lookup degenerates to the nearest cell there.
+	int32_t columnStep = m_field.cols > 1 ? 1 : 0;
+	int32_t rowStep = m_field.rows > 1 ? 1 : 0;
+	int32_t column = min(static_cast<int32_t>(x), m_field.cols - 1 - columnStep);
+	int32_t row = min(static_cast<int32_t>(y), m_field.rows - 1 - rowStep);
+	float dx = x - column;
+	float dy = y - row;
+
+	const float* lower = m_field.ptr<float>(row) + column;
+	const float* upper = m_field.ptr<float>(row + rowStep) + column;
+
+	float bottom = lower[0] + (lower[columnStep] - lower[0]) * dx;
+	float top = upper[0] + (upper[columnStep] - upper[0]) * dx;
+
+	return (bottom + (top - bottom) * dy) * m_resolution;
+}
+
+float ObstacleMap::clearance(const Footprint& footprint) const
+{
+	SamplePoints samples;
+	float spacing = sample(footprint, samples);
+	if (spacing < 0.0f)
+	{
+		return -FLT_MAX;
+	}
+
+	float clearance = FLT_MAX;
+	for (auto& point : samples)
+	{
+		clearance = min(clearance, distance(point));
+	}
+
+	return clearance - spacing / 2.0f;
+}
+
+float ObstacleMap::translationLimit(const Footprint& footprint, const cv::Point2f direction, const float distance) const
+{
+	if (m_field.empty() == true)
+	{
+		return distance;
+	}
+
+	SamplePoints samples;
+	float spacing = sample(footprint, samples);
+	if (spacing < 0.0f)
+	{
+		return 0.0f;
+	}
+
+	return limit(samples, spacing, distance, 1.0f, [direction](const cv::Point2f point, const float distance)
+	{
+		return Point2f(point.x + direction.x * distance, point.y + direction.y * distance);
+	});
+}
+
+float ObstacleMap::rotationLimit(const Footprint& footprint, const cv::Point2f center, const float sign, const float angle) const
+{
+	if (m_field.empty() == true)
+	{
+		return angle;
+	}
+
+	SamplePoints samples;
+	float spacing = sample(footprint, samples);
+	if (spacing < 0.0f)
+	{
+		return 0.0f;
+	}
+
+	float radius = 0.0f;
+	for (auto& point : samples)
+	{
+		radius = max(radius, hypotf(point.x - center.x, point.y - center.y));
+	}
+
+	return limit(samples, spacing, angle, radius, [center, sign](const cv::Point2f point, const float angle)
+	{
+		float cos = cosf(sign * angle);
+		float sin = sinf(sign * angle);
+		return Point2f(
+			center.x + (point.x - center.x) * cos - (point.y - center.y) * sin,
+			center.y + (point.x - center.x) * sin + (point.y - center.y) * cos
+		);
+	});
+}
+
+float ObstacleMap::sweepLimit(const Footprint& footprint, const cv::Point2f center, const cv::Point2f displacement, const float angle) const
+{
+	if (m_field.empty() == true)
+	{
+		return 1.0f;
+	}
+
+	SamplePoints samples;
+	float spacing = sample(footprint, samples);
+	if (spacing < 0.0f)
+	{
+		return 0.0f;
+	}
+
+	float radius = 0.0f;
+	for (auto& point : samples)
+	{
+		radius = max(radius, hypotf(point.x - center.x, point.y - center.y));
+	}
+
+	float rate = hypotf(displacement.x, displacement.y) + radius * fabs(angle);
+
+	return limit(samples, spacing, 1.0f, rate, [center, displacement, angle](const cv::Point2f point, const float time)
+	{
+		float cos = cosf(angle * time);
+		float sin = sinf(angle * time);
+		return Point2f(
+			center.x + displacement.x * time + (point.x - center.x) * cos - (point.y - center.y) * sin,
+			center.y + displacement.y * time + (point.x - center.x) * sin + (point.y - center.y) * cos
+		);
+	});
+}
+
+template <typename Motion>
+float ObstacleMap::limit(const SamplePoints& samples, const float spacing, const float maximum, const float rate, Motion motion) const
+{
+	auto clearance = [this, &samples, spacing, motion](const float parameter)
+	{
+		float clearance = FLT_MAX;
+		for (auto& point : samples)
+		{
+			clearance = min(clearance, distance(motion(point, parameter)));
+		}
+		return clearance - spacing / 2.0f;
+	};
+
+	if (maximum <= 0.0f || rate <= 0.0f)
+	{
+		return maximum;
+	}
+
+	float travelled = 0.0f;
+	float current = clearance(travelled);
+
+	for (int32_t iteration = 0; iteration < ITERATIONS && travelled < maximum; iteration++)
+	{
+		if (current > EPSILON)
+		{
+			travelled = min(maximum, travelled + current / rate);
+			current = clearance(travelled);
+			continue;
+		}
+
+		float step = min(maximum - travelled, spacing / rate);
+		float next = clearance(travelled + step);
+		if (next < current)
+		{
+			break;
+		}
+
+		travelled += step;
+		current = next;
+	}
+
+	return travelled;
+}
+
+void ObstacleMap::build(const cv::Mat& mask)
+{
+	Mat free;
+	Mat occupied;
+	threshold(mask, free, 0, 0xFF, THRESH_BINARY_INV);
+	threshold(mask, occupied, 0, 0xFF, THRESH_BINARY);
+
+	Mat outside;
+	Mat inside;
+	distanceTransform(free, outside, DIST_L2, DIST_MASK_PRECISE);
+	distanceTransform(occupied, inside, DIST_L2, DIST_MASK_PRECISE);
+
+	m_field.create(mask.size(), CV_32FC1);
+	for (int32_t row = 0; row < mask.rows; row++)
+	{
+		const uint8_t* occupiedRow = mask.ptr<uint8_t>(row);
+		const float* outsideRow = outside.ptr<float>(row);
+		const float* insideRow = inside.ptr<float>(row);
+		float* fieldRow = m_field.ptr<float>(row);
+
+		for (int32_t column = 0; column < mask.cols; column++)
+		{
+			fieldRow[column] = occupiedRow[column] != 0 ? 0.5f - insideRow[column] : outsideRow[column] - 0.5f;
+		}
+	}
+}
+
+float ObstacleMap::sample(const Footprint& footprint, SamplePoints& samples) const
+{
+	samples.clear();
+
+	size_t edges = 0;
+	float perimeter = 0.0f;
+	for (size_t part = 0; part < footprint.size; part++)
+	{
+		auto& polygon = footprint.parts[part];
+		for (size_t index = 0; index < polygon.size(); index++)
+		{
+			auto& from = polygon[index];
+			auto& to = polygon[(index + 1) % polygon.size()];
+			perimeter += hypotf(to.x - from.x, to.y - from.y);
+		}
+		edges += polygon.size();
+	}
+
+	if (edges >= SAMPLE_CAPACITY)
+	{
+		return -1.0f;
+	}
+
+	// Every edge rounds its sample count up by at most one.
+	float spacing = max(m_spacing, perimeter / (SAMPLE_CAPACITY - edges));
+
+	for (size_t part = 0; part < footprint.size; part++)
+	{
+		auto& polygon = footprint.parts[part];
+
+		for (size_t index = 0; index < polygon.size(); index++)
+		{
+			auto& from = polygon[index];
+			auto& to = polygon[(index + 1) % polygon.size()];
+			int32_t steps = max(1, cvCeil(hypotf(to.x - from.x, to.y - from.y) / spacing));
+
+			for (int32_t step = 0; step < steps; step++)
+			{
+				float fraction = static_cast<float>(step) / steps;
+				if (samples.append(Point2f(from.x + (to.x - from.x) * fraction, from.y + (to.y - from.y) * fraction)) != 0)
+				{
+					return -1.0f;
+				}
+			}
+		}
+	}
+
+	return spacing;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "robot.h"
+
+#define SAMPLE_CAPACITY 512
+#define SAMPLE_SPACING 4.0f
+
+typedef InlinePoints<SAMPLE_CAPACITY> SamplePoints;
+
+// Static obstacles stored as a signed distance field in world coordinates
+// (negative inside obstacles), one cell per `resolution` world units. Images
+// are read like the rendered frame: row 0 is the top of the arena and dark
+// pixels are obstacles; an image pixel is one world unit, so the image is
+// resampled to the field size. Motion limits sample the footprint edges every
+// `spacing` units and subtract half of it, so they stay conservative between
+// samples. An outline too long for SAMPLE_CAPACITY samples is sampled coarser,
+// with the margin growing to match; one with more edges than that is blocked.
+// A resolution that is not a positive finite number falls back to 1 and a
+// spacing that is not positive falls back to SAMPLE_SPACING.
+class ObstacleMap
+{
+public:
+	ObstacleMap(const float resolution = 1.0f, const float spacing = SAMPLE_SPACING);
+	~ObstacleMap() = default;
+
+	int32_t load(const cv::Mat& image);
+	int32_t load(const std::vector<PolygonPoints>& polygons, const cv::Size2i area);
+	void clear();
+	bool empty() const;
+
+	float resolution() const;
+	float spacing() const;
+	cv::Size2i size() const;
+	const cv::Mat& field() const;
+
+	float distance(const cv::Point2f point) const;
+	float clearance(const Footprint& footprint) const;
+
+	float translationLimit(const Footprint& footprint, const cv::Point2f direction, const float distance) const;
+	float rotationLimit(const Footprint& footprint, const cv::Point2f center, const float sign, const float angle) const;
+	float sweepLimit(const Footprint& footprint, const cv::Point2f center, const cv::Point2f displacement, const float angle) const;
+
+private:
+	void build(const cv::Mat& mask);
+	float sample(const Footprint& footprint, SamplePoints& samples) const;
+
+	template <typename Motion>
+	float limit(const SamplePoints& samples, const float spacing, const float maximum, const float rate, Motion motion) const;
+
+	float m_resolution;
+	float m_spacing;
+	cv::Mat m_field;
+};
@@ -0,0 +1,59 @@
+#include "benchmark.h"
+#include "obstacle_map.h"
+#include "opencv2/imgproc.hpp"
+
+#include <random>
+
+#define MAP_SIZE 4096
+#define MAP_OBSTACLES 2048
+
+using namespace std;
+using namespace cv;
+
+void benchmarkObstacleMap(Benchmark& benchmark)
+{
+	mt19937 random(benchmark.seed());
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	auto image = Mat(MAP_SIZE, MAP_SIZE, CV_8UC1, Scalar(0xFF));
+	for (int32_t obstacle = 0; obstacle < MAP_OBSTACLES; obstacle++)
+	{
+		auto center = Point2f(MAP_SIZE * unit(random), MAP_SIZE * unit(random));
+		float radius = 8.0f + 56.0f * unit(random);
+		float angle = static_cast<float>(2.0 * M_PI) * unit(random);
+
+		Point corners[4];
+		for (int32_t corner = 0; corner < 4; corner++)
+		{
+			float phi = angle + corner * static_cast<float>(M_PI_2);
+			corners[corner] = Point(cvRound(center.x + radius * cosf(phi)), cvRound(center.y + radius * sinf(phi)));
+		}
+		fillConvexPoly(image, corners, 4, Scalar(0));
+	}
+
+	ObstacleMap obstacles;
+
+	benchmark.measure("ObstacleMap::load/4096x4096", 1, [&obstacles, &image](size_t)
+	{
+		return static_cast<float>(obstacles.load(image));
+	});
+
+	vector<Footprint> footprints;
+	vector<Point2f> centers;
+	for (auto& robot : benchmark.robots())
+	{
+		footprints.push_back(robot.footprint());
+		centers.push_back(robot.center());
+	}
+
+	benchmark.measure("ObstacleMap::translationLimit", footprints.size(), [&obstacles, &footprints](size_t index)
+	{
+		auto direction = index % 2 == 0 ? Point2f(1.0f, 0.0f) : Point2f(0.0f, 1.0f);
+		return obstacles.translationLimit(footprints[index], direction, SPEED);
+	});
+
+	benchmark.measure("ObstacleMap::rotationLimit", footprints.size(), [&obstacles, &footprints, &centers](size_t index)
+	{
+		return obstacles.rotationLimit(footprints[index], centers[index], index % 2 == 0 ? 1.0f : -1.0f, ANGULAR_SPEED);
+	});
+}
@@ -0,0 +1,453 @@
+#include "planner.h"
+#include "obstacle_map.h"
+
+#include <algorithm>
+
+#define ACTIONS 10
+#define NO_PARENT UINT32_MAX
+#define PLANNER_WEIGHT 1.5f
+
+using namespace std;
+using namespace cv;
+
+namespace
+{
+	const Command ACTION_TABLE[ACTIONS] =
+	{
+		{ CommandType::MOVE,   Direction::FORWARD, Rotation::CLOCKWISE         },
+		{ CommandType::MOVE,   Direction::BACK,    Rotation::CLOCKWISE         },
+		{ CommandType::MOVE,   Direction::LEFT,    Rotation::CLOCKWISE         },
+		{ CommandType::MOVE,   Direction::RIGHT,   Rotation::CLOCKWISE         },
+		{ CommandType::ROTATE, Direction::FORWARD, Rotation::CLOCKWISE         },
+		{ CommandType::ROTATE, Direction::FORWARD, Rotation::COUNTER_CLOCKWISE },
+		{ CommandType::GO,     Direction::FORWARD, Rotation::COUNTER_CLOCKWISE },
+		{ CommandType::GO,     Direction::FORWARD, Rotation::CLOCKWISE         },
+		{ CommandType::GO,     Direction::BACK,    Rotation::CLOCKWISE         },
+		{ CommandType::GO,     Direction::BACK,    Rotation::COUNTER_CLOCKWISE }
+	};
+
+	float wrap(const float angle)
+	{
+		float wrapped = fmodf(angle, static_cast<float>(2.0 * M_PI));
+		if (wrapped > M_PI)
+		{
+			wrapped -= static_cast<float>(2.0 * M_PI);
+		}
+		if (wrapped < -M_PI)
+		{
+			wrapped += static_cast<float>(2.0 * M_PI);
+		}
+		return wrapped;
+	}
+}
+
+Planner::Planner(Robot& robot, const size_t maxExpansions) :
+	m_robot(robot),
+	m_maxExpansions(maxExpansions),
+	m_expansions(0),
+	m_border({ 0.0f, 0.0f, 0.0f, 0.0f }),
+	m_speed(0.0f),
+	m_angularSpeed(0.0f),
+	m_obstacles(nullptr),
+	m_radius(0.0f),
+	m_cell(0.0f),
+	m_columns(0),
+	m_rows(0),
+	m_stamp(0)
+{
+
+}
+
+int32_t Planner::plan(const cv::Point2f goal, const float goalAngle, std::vector<Command>& commands)
+{
+	commands.clear();
+	m_expansions = 0;
+
+	prepare();
+
+	if (m_speed <= 0.0f || m_angularSpeed <= 0.0f || bin(goal.x, goal.y, goalAngle) < 0 || free(goal, goalAngle) == false)
+	{
+		return -1;
+	}
+
+	if (++m_stamp == 0)
+	{
+		fill(m_stamps.begin(), m_stamps.end(), 0);
+		m_stamp = 1;
+	}
+
+	m_nodes.clear();
+	m_open.clear();
+
+	auto start = m_robot.center();
+	Node first = { start.x, start.y, m_robot.angle(), 0.0f, NO_PARENT, 0, false };
+	m_nodes.push_back(first);
+	m_open.push_back(make_pair(heuristic(first, goal, goalAngle), 0u));
+
+	int64_t startBin = bin(start.x, start.y, first.angle);
+	if (startBin >= 0)
+	{
+		m_bins[startBin] = 0;
+		m_stamps[startBin] = m_stamp;
+	}
+
+	float rotationCost = m_angularSpeed * m_radius;
+	auto compare = [](const pair<float, uint32_t>& first, const pair<float, uint32_t>& second)
+	{
+		return first.first > second.first;
+	};
+
+	while (m_open.empty() == false && m_expansions < m_maxExpansions)
+	{
+		pop_heap(m_open.begin(), m_open.end(), compare);
+		auto current = m_open.back();
+		m_open.pop_back();
+
+		Node node = m_nodes[current.second];
+		if (node.closed == true || current.first > node.cost + heuristic(node, goal, goalAngle) + 0.001f)
+		{
+			continue;
+		}
+		m_nodes[current.second].closed = true;
+		m_expansions++;
+
+		if (fabs(wrap(node.angle - goalAngle)) <= m_angularSpeed / 2.0f + 0.0001f && shot(node, goal, m_shot) == true)
+		{
+			for (uint32_t index = current.second; m_nodes[index].parent != NO_PARENT; index = m_nodes[index].parent)
+			{
+				commands.push_back(ACTION_TABLE[m_nodes[index].action]);
+			}
+			reverse(commands.begin(), commands.end());
+			commands.insert(commands.end(), m_shot.begin(), m_shot.end());
+			return 0;
+		}
+
+		float cos = cosf(node.angle);
+		float sin = sinf(node.angle);
+
+		for (uint8_t action = 0; action < ACTIONS; action++)
+		{
+			auto& command = ACTION_TABLE[action];
+			Node next = { node.x, node.y, node.angle, node.cost, current.second, action, false };
+
+			if (command.type != CommandType::ROTATE)
+			{
+				switch (command.direction)
+				{
+				case Direction::FORWARD:
+					next.x += m_speed * cos;
+					next.y += m_speed * sin;
+					break;
+				case Direction::BACK:
+					next.x -= m_speed * cos;
+					next.y -= m_speed * sin;
+					break;
+				case Direction::LEFT:
+					next.x -= m_speed * sin;
+					next.y += m_speed * cos;
+					break;
+				case Direction::RIGHT:
+					next.x += m_speed * sin;
+					next.y -= m_speed * cos;
+					break;
+				}
+				next.cost += m_speed;
+			}
+
+			if (command.type != CommandType::MOVE)
+			{
+				next.angle += command.rotation == Rotation::CLOCKWISE ? -m_angularSpeed : m_angularSpeed;
+				next.cost += rotationCost;
+			}
+
+			int64_t nextBin = bin(next.x, next.y, next.angle);
+			if (nextBin < 0 || m_free[nextBin] == 0)
+			{
+				continue;
+			}
+
+			if (m_stamps[nextBin] == m_stamp)
+			{
+				auto& existing = m_nodes[m_bins[nextBin]];
+				if (existing.closed == true || existing.cost <= next.cost)
+				{
+					continue;
+				}
+				existing = next;
+				m_open.push_back(make_pair(next.cost + heuristic(next, goal, goalAngle), m_bins[nextBin]));
+				push_heap(m_open.begin(), m_open.end(), compare);
+				continue;
+			}
+
+			m_stamps[nextBin] = m_stamp;
+			m_bins[nextBin] = static_cast<uint32_t>(m_nodes.size());
+			m_nodes.push_back(next);
+			m_open.push_back(make_pair(next.cost + heuristic(next, goal, goalAngle), m_bins[nextBin]));
+			push_heap(m_open.begin(), m_open.end(), compare);
+		}
+	}
+
+	return -2;
+}
+
+bool Planner::free(const cv::Point2f center, const float angle)
+{
+	prepare();
+
+	int64_t index = bin(center.x, center.y, angle);
+	return index >= 0 && m_free[index] != 0;
+}
+
+size_t Planner::expansions() const
+{
+	return m_expansions;
+}
+
+bool Planner::shot(const Node& node, const cv::Point2f goal, std::vector<Command>& commands) const
+{
+	commands.clear();
+
+	float cos = cosf(node.angle);
+	float sin = sinf(node.angle);
+	float dx = goal.x - node.x;
+	float dy = goal.y - node.y;
+
+	auto forward = static_cast<int32_t>(roundf((dx * cos + dy * sin) / m_speed));
+	auto left = static_cast<int32_t>(roundf((dy * cos - dx * sin) / m_speed));
+
+	float x = node.x;
+	float y = node.y;
+	auto step = [&](const Direction direction, const float stepX, const float stepY, const int32_t count)
+	{
+		for (int32_t counter = 0; counter < count; counter++)
+		{
+			x += stepX;
+			y += stepY;
+
+			int64_t index = bin(x, y, node.angle);
+			if (index < 0 || m_free[index] == 0)
+			{
+				return false;
+			}
+			commands.push_back({ CommandType::MOVE, direction, Rotation::CLOCKWISE });
+		}
+		return true;
+	};
+
+	float along = forward >= 0 ? m_speed : -m_speed;
+	float across = left >= 0 ? m_speed : -m_speed;
+
+	bool clear =
+		step(forward >= 0 ? Direction::FORWARD : Direction::BACK, along * cos, along * sin, abs(forward)) &&
+		step(left >= 0 ? Direction::LEFT : Direction::RIGHT, -across * sin, across * cos, abs(left));
+
+	return clear == true && hypotf(goal.x - x, goal.y - y) <= m_cell;
+}
+
+char Planner::key(const Command& command)
+{
+	switch (command.type)
+	{
+	case CommandType::MOVE:
+	{
+		const char keys[] = { 'w', 'a', 's', 'd' };
+		return keys[static_cast<uint32_t>(command.direction)];
+	}
+	case CommandType::ROTATE:
+		return command.rotation == Rotation::CLOCKWISE ? '.' : ',';
+	case CommandType::GO:
+		if (command.direction == Direction::FORWARD)
+		{
+			return command.rotation == Rotation::CLOCKWISE ? 'e' : 'q';
+		}
+		return command.rotation == Rotation::CLOCKWISE ? 'z' : 'x';
+	default:
+		return 0;
+	}
+}
+
+int32_t Planner::execute(Robot& robot, const Command& command)
+{
+	switch (command.type)
+	{
+	case CommandType::MOVE:
+		return robot.move(command.direction);
+	case CommandType::ROTATE:
+		return robot.rotate(command.rotation);
+	case CommandType::GO:
+		return robot.go(command.direction, command.rotation);
+	default:
+		return -1;
+	}
+}
+
+void Planner::prepare()
+{
+	auto local = localPoints();
+	if (stale(local) == false)
+	{
+		return;
+	}
+
+	m_local = local;
+	m_border = m_robot.border();
+	m_speed = m_robot.speed();
+	m_angularSpeed = m_robot.angularSpeed();
+	m_obstacles = m_robot.obstacles();
+
+	m_radius = 0.0f;
+	for (auto& point : m_local)
+	{
+		m_radius = max(m_radius, hypotf(point.x, point.y));
+	}
+
+	m_cell = max(m_speed, 1.0f);
+	m_columns = static_cast<int32_t>(ceilf((m_border.right + 1.0f) / m_cell));
+	m_rows = static_cast<int32_t>(ceilf((m_border.top + 1.0f) / m_cell));
+	if (m_columns <= 0 || m_rows <= 0)
+	{
+		m_columns = 0;
+		m_rows = 0;
+	}
+
+	size_t size = static_cast<size_t>(m_columns) * m_rows * PLANNER_HEADINGS;
+	m_free.assign(size, 0);
+	m_bins.resize(size);
+	m_stamps.assign(size, 0);
+	m_stamp = 0;
+
+	float binAngle = static_cast<float>(2.0 * M_PI) / PLANNER_HEADINGS;
+	float margin = m_cell * static_cast<float>(M_SQRT1_2) + m_radius * binAngle / 2.0f;
+	auto obstacles = m_robot.obstacles();
+
+	Footprint footprint = m_robot.footprint();
+	auto origin = m_robot.center();
+	float angle = m_robot.angle();
+	for (size_t part = 0; part < footprint.size; part++)
+	{
+		for (auto& point : footprint.parts[part])
+		{
+			auto offset = point - origin;
+			point = Point2f(offset.x * cosf(angle) + offset.y * sinf(angle), -offset.x * sinf(angle) + offset.y * cosf(angle));
+		}
+	}
+
+	for (int32_t heading = 0; heading < PLANNER_HEADINGS; heading++)
+	{
+		float theta = (heading + 0.5f) * binAngle;
+		float cos = cosf(theta);
+		float sin = sinf(theta);
+
+		Border extent = { -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX };
+		for (auto& point : m_local)
+		{
+			float x = point.x * cos - point.y * sin;
+			float y = point.x * sin + point.y * cos;
+			extent.right = max(extent.right, x);
+			extent.top = max(extent.top, y);
+			extent.left = min(extent.left, x);
+			extent.bottom = min(extent.bottom, y);
+		}
+
+		auto first = [this](const float low) { return max(0, static_cast<int32_t>(ceilf(low / m_cell - 0.5f))); };
+		auto last = [this](const float high) { return static_cast<int32_t>(floorf(high / m_cell - 0.5f)); };
+
+		int32_t columnFirst = first(m_border.left - extent.left + margin);
+		int32_t columnLast = min(m_columns - 1, last(m_border.right - extent.right - margin));
+		int32_t rowFirst = first(m_border.bottom - extent.bottom + margin);
+		int32_t rowLast = min(m_rows - 1, last(m_border.top - extent.top - margin));
+
+		for (int32_t row = rowFirst; row <= rowLast; row++)
+		{
+			float y = (row + 0.5f) * m_cell;
+			auto cells = &m_free[(static_cast<size_t>(heading) * m_rows + row) * m_columns];
+
+			for (int32_t column = columnFirst; column <= columnLast; column++)
+			{
+				float x = (column + 0.5f) * m_cell;
+
+				bool clear = true;
+				if (obstacles != nullptr && obstacles->empty() == false && obstacles->distance(Point2f(x, y)) < m_radius + margin)
+				{
+					Footprint pose = footprint;
+					for (size_t part = 0; part < pose.size; part++)
+					{
+						for (auto& point : pose.parts[part])
+						{
+							point = Point2f(x + point.x * cos - point.y * sin, y + point.x * sin + point.y * cos);
+						}
+					}
+					clear = obstacles->clearance(pose) >= margin;
+				}
+
+				cells[column] = clear == true ? 1 : 0;
+			}
+		}
+	}
+}
+
+bool Planner::stale(const PolygonPoints& local) const
+{
+	auto border = m_robot.border();
+	if (m_free.empty() == true || m_speed != m_robot.speed() || m_angularSpeed != m_robot.angularSpeed() ||
+		m_obstacles != m_robot.obstacles() || local.size() != m_local.size() ||
+		border.right != m_border.right || border.top != m_border.top ||
+		border.left != m_border.left || border.bottom != m_border.bottom)
+	{
+		return true;
+	}
+
+	for (size_t index = 0; index < local.size(); index++)
+	{
+		if (fabs(local[index].x - m_local[index].x) > 0.01f || fabs(local[index].y - m_local[index].y) > 0.01f)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+PolygonPoints Planner::localPoints()
+{
+	auto points = m_robot.boundaryPoints();
+	auto origin = m_robot.center();
+	float angle = m_robot.angle();
+
+	for (auto& point : points)
+	{
+		auto offset = point - origin;
+		point = Point2f(offset.x * cosf(angle) + offset.y * sinf(angle), -offset.x * sinf(angle) + offset.y * cosf(angle));
+	}
+
+	return points;
+}
+
+int64_t Planner::bin(const float x, const float y, const float angle) const
+{
+	if (m_cell <= 0.0f || x < 0.0f || y < 0.0f)
+	{
+		return -1;
+	}
+
+	auto column = static_cast<int32_t>(x / m_cell);
+	auto row = static_cast<int32_t>(y / m_cell);
+	if (column >= m_columns || row >= m_rows)
+	{
+		return -1;
+	}
+
+	float turn = fmodf(angle, static_cast<float>(2.0 * M_PI));
+	if (turn < 0.0f)
+	{
+		turn += static_cast<float>(2.0 * M_PI);
+	}
+	auto heading = static_cast<int32_t>(turn / static_cast<float>(2.0 * M_PI) * PLANNER_HEADINGS) % PLANNER_HEADINGS;
+
+	return (static_cast<int64_t>(heading) * m_rows + row) * m_columns + column;
+}
+
+float Planner::heuristic(const Node& node, const cv::Point2f goal, const float goalAngle) const
+{
+	return PLANNER_WEIGHT * (hypotf(node.x - goal.x, node.y - goal.y) + m_radius * fabs(wrap(goalAngle - node.angle)));
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+
+#include "robot.h"
+
+#define PLANNER_HEADINGS 64
+
+enum class CommandType
+{
+	MOVE,
+	ROTATE,
+	GO
+};
+
+struct Command
+{
+	CommandType type;
+	Direction direction;
+	Rotation rotation;
+};
+
+// Hybrid A* over the robot's own move/rotate/go steps. Collisions are looked
+// up in a configuration-space grid with one cell per speed step and
+// PLANNER_HEADINGS orientation bins. A grid cell is marked free only when
+// every pose inside it keeps the footprint inside the Border and clear of the
+// obstacle map. The grid is rebuilt when the border, speeds, obstacles or
+// footprint change.
+class Planner
+{
+public:
+	Planner(Robot& robot, const size_t maxExpansions = 200000);
+	~Planner() = default;
+
+	int32_t plan(const cv::Point2f goal, const float goalAngle, std::vector<Command>& commands);
+
+	bool free(const cv::Point2f center, const float angle);
+	size_t expansions() const;
+
+	static char key(const Command& command);
+	static int32_t execute(Robot& robot, const Command& command);
+
+private:
+	struct Node
+	{
+		float x;
+		float y;
+		float angle;
+		float cost;
+		uint32_t parent;
+		uint8_t action;
+		bool closed;
+	};
+
+	void prepare();
+	bool stale(const PolygonPoints& local) const;
+	PolygonPoints localPoints();
+	int64_t bin(const float x, const float y, const float angle) const;
+	bool shot(const Node& node, const cv::Point2f goal, std::vector<Command>& commands) const;
+	float heuristic(const Node& node, const cv::Point2f goal, const float goalAngle) const;
+
+	Robot& m_robot;
+	size_t m_maxExpansions;
+	size_t m_expansions;
+
+	PolygonPoints m_local;
+	Border m_border;
+	float m_speed;
+	float m_angularSpeed;
+	const ObstacleMap* m_obstacles;
+	float m_radius;
+	float m_cell;
+	int32_t m_columns;
+	int32_t m_rows;
+	std::vector<uint8_t> m_free;
+
+	std::vector<Node> m_nodes;
+	std::vector<uint32_t> m_bins;
+	std::vector<uint32_t> m_stamps;
+	uint32_t m_stamp;
+	std::vector<std::pair<float, uint32_t>> m_open;
+	std::vector<Command> m_shot;
+};
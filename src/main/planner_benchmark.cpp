@@ -0,0 +1,17 @@
+#include "benchmark.h"
+#include "planner.h"
+
+using namespace std;
+using namespace cv;
+
+void benchmarkPlanner(Benchmark& benchmark)
+{
+	Planner planner(benchmark.robots().front());
+	vector<Command> commands;
+	auto goal = Point2f(benchmark.area().width * 0.25f, benchmark.area().height * 0.75f);
+
+	benchmark.measure("Planner::plan", 1, [&planner, &commands, goal](size_t)
+	{
+		return static_cast<float>(planner.plan(goal, 0.0f, commands) + commands.size());
+	});
+}
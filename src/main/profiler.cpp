@@ -0,0 +1,298 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+using namespace std;
+
+namespace
+{
+	struct Event
+	{
+		uint32_t site;
+		uint64_t id;
+		int64_t start;
+		int64_t value;
+	};
+
+	struct Site
+	{
+		uint64_t count;
+		int64_t total;
+		int64_t minimum;
+		int64_t maximum;
+		uint64_t histogram[PROFILE_BUCKETS];
+	};
+
+	struct ThreadProfile
+	{
+		uint32_t thread;
+		uint64_t written;
+		Site sites[PROFILE_SITES];
+		Event events[PROFILE_EVENTS];
+	};
+
+	struct Registry
+	{
+		mutex lock;
+		const char* names[PROFILE_SITES];
+		bool counters[PROFILE_SITES];
+		uint32_t size;
+		vector<unique_ptr<ThreadProfile>> threads;
+		chrono::steady_clock::time_point epoch;
+	};
+
+	Registry& registry()
+	{
+		static Registry instance = { {}, { "overflow", "overflow" }, { false, true }, 2, {}, chrono::steady_clock::now() };
+		return instance;
+	}
+
+	void clear(ThreadProfile& profile)
+	{
+		profile.written = 0;
+		for (auto& site : profile.sites)
+		{
+			site.count = 0;
+			site.total = 0;
+			site.minimum = INT64_MAX;
+			site.maximum = INT64_MIN;
+			fill(site.histogram, site.histogram + PROFILE_BUCKETS, 0);
+		}
+	}
+
+	ThreadProfile& threadProfile()
+	{
+		thread_local ThreadProfile* profile = nullptr;
+		if (profile != nullptr)
+		{
+			return *profile;
+		}
+
+		auto& instance = registry();
+		lock_guard<mutex> guard(instance.lock);
+
+		instance.threads.emplace_back(new ThreadProfile());
+		profile = instance.threads.back().get();
+		profile->thread = static_cast<uint32_t>(instance.threads.size());
+		clear(*profile);
+
+		return *profile;
+	}
+
+	uint32_t bucket(const int64_t value)
+	{
+		uint64_t magnitude = value < 0 ? static_cast<uint64_t>(-value) : static_cast<uint64_t>(value);
+		uint32_t result = 0;
+		while (magnitude != 0 && result < PROFILE_BUCKETS - 1)
+		{
+			magnitude >>= 1;
+			result++;
+		}
+		return result;
+	}
+
+	void add(const uint32_t site, const uint64_t id, const int64_t start, const int64_t value)
+	{
+		auto& profile = threadProfile();
+		auto& statistics = profile.sites[site];
+
+		statistics.count++;
+		statistics.total += value;
+		statistics.minimum = min(statistics.minimum, value);
+		statistics.maximum = max(statistics.maximum, value);
+		statistics.histogram[bucket(value)]++;
+
+		Event event = { site, id, start, value };
+		profile.events[profile.written % PROFILE_EVENTS] = event;
+		profile.written++;
+	}
+
+	double percentile(const ProfileStatistics& statistics, const double fraction)
+	{
+		uint64_t rank = static_cast<uint64_t>(ceil(fraction * statistics.count));
+		uint64_t seen = 0;
+
+		for (uint32_t index = 0; index < PROFILE_BUCKETS; index++)
+		{
+			seen += statistics.histogram[index];
+			if (seen >= rank && seen > 0)
+			{
+				double upper = index == 0 ? 0.0 : ldexp(1.0, index);
+				return min(upper, static_cast<double>(statistics.maximum));
+			}
+		}
+
+		return static_cast<double>(statistics.maximum);
+	}
+
+	void writeName(std::ostream& stream, const char* name)
+	{
+		stream << '"';
+		for (auto character = name; *character != 0; character++)
+		{
+			if (*character == '"' || *character == '\\')
+			{
+				stream << '\\';
+			}
+			stream << *character;
+		}
+		stream << '"';
+	}
+}
+
+bool Profiler::enabled()
+{
+#ifdef ROBOT_PROFILE
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint32_t Profiler::site(const char* name, const bool counter)
+{
+	auto& instance = registry();
+	lock_guard<mutex> guard(instance.lock);
+
+	for (uint32_t index = 0; index < instance.size; index++)
+	{
+		if (strcmp(instance.names[index], name) == 0 && instance.counters[index] == counter)
+		{
+			return index;
+		}
+	}
+
+	if (instance.size == PROFILE_SITES)
+	{
+		return counter == true ? PROFILE_OVERFLOW_COUNTER : PROFILE_OVERFLOW_TIMER;
+	}
+
+	instance.names[instance.size] = name;
+	instance.counters[instance.size] = counter;
+	return instance.size++;
+}
+
+int64_t Profiler::now()
+{
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - registry().epoch).count();
+}
+
+void Profiler::record(const uint32_t site, const uint64_t id, const int64_t start, const int64_t duration)
+{
+	add(site, id, start, duration);
+}
+
+void Profiler::count(const uint32_t site, const uint64_t id, const int64_t value)
+{
+	add(site, id, now(), value);
+}
+
+std::vector<ProfileStatistics> Profiler::statistics()
+{
+	auto& instance = registry();
+	lock_guard<mutex> guard(instance.lock);
+
+	vector<ProfileStatistics> result;
+
+	for (uint32_t site = 0; site < instance.size; site++)
+	{
+		ProfileStatistics statistics = { instance.names[site], instance.counters[site], 0, 0, INT64_MAX, INT64_MIN, {} };
+
+		for (auto& profile : instance.threads)
+		{
+			auto& current = profile->sites[site];
+			statistics.count += current.count;
+			statistics.total += current.total;
+			statistics.minimum = min(statistics.minimum, current.minimum);
+			statistics.maximum = max(statistics.maximum, current.maximum);
+			for (uint32_t index = 0; index < PROFILE_BUCKETS; index++)
+			{
+				statistics.histogram[index] += current.histogram[index];
+			}
+		}
+
+		if (statistics.count > 0)
+		{
+			result.push_back(statistics);
+		}
+	}
+
+	return result;
+}
+
+void Profiler::reset()
+{
+	auto& instance = registry();
+	lock_guard<mutex> guard(instance.lock);
+
+	for (auto& profile : instance.threads)
+	{
+		clear(*profile);
+	}
+}
+
+void Profiler::writeCsv(std::ostream& stream)
+{
+	stream << "name,kind,count,total,mean,min,max,p50,p90,p99" << endl;
+
+	for (auto& statistics : Profiler::statistics())
+	{
+		double scale = statistics.counter == true ? 1.0 : 1e-3;
+
+		writeName(stream, statistics.name);
+		stream << ',' << (statistics.counter == true ? "counter" : "timer_us")
+		       << ',' << statistics.count
+		       << ',' << statistics.total * scale
+		       << ',' << static_cast<double>(statistics.total) / statistics.count * scale
+		       << ',' << statistics.minimum * scale
+		       << ',' << statistics.maximum * scale
+		       << ',' << percentile(statistics, 0.5) * scale
+		       << ',' << percentile(statistics, 0.9) * scale
+		       << ',' << percentile(statistics, 0.99) * scale << endl;
+	}
+}
+
+void Profiler::writeTrace(std::ostream& stream)
+{
+	auto& instance = registry();
+	lock_guard<mutex> guard(instance.lock);
+
+	auto flags = stream.flags();
+	auto precision = stream.precision();
+	stream << fixed << setprecision(3) << "{\"traceEvents\":[";
+	bool first = true;
+
+	for (auto& profile : instance.threads)
+	{
+		uint64_t begin = profile->written > PROFILE_EVENTS ? profile->written - PROFILE_EVENTS : 0;
+
+		for (uint64_t index = begin; index < profile->written; index++)
+		{
+			auto& event = profile->events[index % PROFILE_EVENTS];
+
+			stream << (first == true ? "\n" : ",\n") << "{\"name\":";
+			writeName(stream, instance.names[event.site]);
+			stream << ",\"pid\":1,\"tid\":" << profile->thread << ",\"ts\":" << event.start / 1000.0;
+
+			if (instance.counters[event.site] == true)
+			{
+				stream << ",\"ph\":\"C\",\"id\":" << event.id << ",\"args\":{\"value\":" << event.value << "}}";
+			}
+			else
+			{
+				stream << ",\"ph\":\"X\",\"dur\":" << event.value / 1000.0 << ",\"args\":{\"id\":" << event.id << "}}";
+			}
+			first = false;
+		}
+	}
+
+	stream << "\n]}" << endl;
+	stream.flags(flags);
+	stream.precision(precision);
+}
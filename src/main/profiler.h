@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#define PROFILE_SITES 256
+#define PROFILE_EVENTS 65536
+#define PROFILE_BUCKETS 64
+#define PROFILE_OVERFLOW_TIMER 0
+#define PROFILE_OVERFLOW_COUNTER 1
+
+struct ProfileStatistics
+{
+	const char* name;
+	bool counter;
+	uint64_t count;
+	int64_t total;
+	int64_t minimum;
+	int64_t maximum;
+	uint64_t histogram[PROFILE_BUCKETS];
+};
+
+// Scoped timers and counters for the tick hot path. Each thread records into
+// its own statistics table and event ring, so recording takes no lock; a
+// site is registered once per call site through a function-local static.
+// Two sites named "overflow", one timer and one counter, are registered up
+// front; once all PROFILE_SITES are taken, new sites record into them
+// rather than into a real site.
+// Timer values are nanoseconds and histograms use power-of-two buckets.
+// Statistics and traces must be written after the recording threads have
+// stopped. Without ROBOT_PROFILE the PROFILE_* macros expand to nothing and
+// their arguments are not evaluated.
+class Profiler
+{
+public:
+	static bool enabled();
+
+	static uint32_t site(const char* name, const bool counter = false);
+	static int64_t now();
+	static void record(const uint32_t site, const uint64_t id, const int64_t start, const int64_t duration);
+	static void count(const uint32_t site, const uint64_t id, const int64_t value);
+
+	static std::vector<ProfileStatistics> statistics();
+	static void reset();
+
+	static void writeCsv(std::ostream& stream);
+	static void writeTrace(std::ostream& stream);
+};
+
+class ScopedTimer
+{
+public:
+	ScopedTimer(const uint32_t site, const uint64_t id = 0) :
+		m_site(site),
+		m_id(id),
+		m_start(Profiler::now())
+	{
+
+	}
+
+	~ScopedTimer()
+	{
+		Profiler::record(m_site, m_id, m_start, Profiler::now() - m_start);
+	}
+
+private:
+	uint32_t m_site;
+	uint64_t m_id;
+	int64_t m_start;
+};
+
+#ifdef ROBOT_PROFILE
+#define PROFILE_JOIN_(first, second) first##second
+#define PROFILE_JOIN(first, second) PROFILE_JOIN_(first, second)
+#define PROFILE_SCOPE_ID(name, id) \
+	static const uint32_t PROFILE_JOIN(profileSite, __LINE__) = Profiler::site(name); \
+	ScopedTimer PROFILE_JOIN(profileTimer, __LINE__)(PROFILE_JOIN(profileSite, __LINE__), static_cast<uint64_t>(id))
+#define PROFILE_COUNT_ID(name, id, value) \
+	do \
+	{ \
+		static const uint32_t profileSite = Profiler::site(name, true); \
+		Profiler::count(profileSite, static_cast<uint64_t>(id), static_cast<int64_t>(value)); \
+	} while (false)
+#else
+#define PROFILE_SCOPE_ID(name, id) do { } while (false)
+#define PROFILE_COUNT_ID(name, id, value) do { } while (false)
+#endif
+
+#define PROFILE_SCOPE(name) PROFILE_SCOPE_ID(name, 0)
+#define PROFILE_COUNT(name, value) PROFILE_COUNT_ID(name, 0, value)
@@ -0,0 +1,336 @@
+#include "projectile_pool.h"
+#include "simd.h"
+
+#include <algorithm>
+
+#define NO_HIT 2.0f
+
+using namespace std;
+using namespace cv;
+
+ProjectilePool::ProjectilePool(const size_t capacity, const Border border) :
+	m_size(0),
+	m_capacity(capacity),
+	m_border(border)
+{
+	size_t padded = (capacity + simd::LANES - 1) / simd::LANES * simd::LANES;
+
+	m_positionX.assign(padded, 0.0f);
+	m_positionY.assign(padded, 0.0f);
+	m_velocityX.assign(padded, 0.0f);
+	m_velocityY.assign(padded, 0.0f);
+	m_lifetime.assign(padded, 0.0f);
+	m_owner.assign(padded, 0);
+
+	m_hits.reserve(capacity);
+}
+
+int32_t ProjectilePool::spawn(const cv::Point2f position, const cv::Point2f velocity, const float lifetime, const uint32_t owner)
+{
+	if (lifetime <= 0.0f)
+	{
+		return -1;
+	}
+
+	if (m_size == m_capacity)
+	{
+		return -2;
+	}
+
+	m_positionX[m_size] = position.x;
+	m_positionY[m_size] = position.y;
+	m_velocityX[m_size] = velocity.x;
+	m_velocityY[m_size] = velocity.y;
+	m_lifetime[m_size] = lifetime;
+	m_owner[m_size] = owner;
+	m_size++;
+
+	return 0;
+}
+
+int32_t ProjectilePool::fire(WarRobot& robot, const uint32_t owner, const float speed, const float lifetime)
+{
+	Point2f origin;
+	Point2f direction;
+	robot.muzzle(origin, direction);
+
+	return spawn(origin, direction * speed, lifetime, owner);
+}
+
+int32_t ProjectilePool::step(const float timestep, const std::vector<Robot*>& targets)
+{
+	m_hits.clear();
+
+	if (timestep <= 0.0f)
+	{
+		return -1;
+	}
+
+	prepare(targets);
+
+	const simd::Lane dt = simd::set(timestep);
+	const simd::Lane zero = simd::set(0.0f);
+	const simd::Lane one = simd::set(1.0f);
+	const simd::Lane tiny = simd::set(1e-12f);
+	const simd::Lane dead = simd::set(-1.0f);
+	const simd::Lane right = simd::set(m_border.right);
+	const simd::Lane top = simd::set(m_border.top);
+	const simd::Lane left = simd::set(m_border.left);
+	const simd::Lane bottom = simd::set(m_border.bottom);
+
+	for (size_t index = 0; index < m_size; index += simd::LANES)
+	{
+		simd::Lane x = simd::load(&m_positionX[index]);
+		simd::Lane y = simd::load(&m_positionY[index]);
+		simd::Lane dx = simd::mul(simd::load(&m_velocityX[index]), dt);
+		simd::Lane dy = simd::mul(simd::load(&m_velocityY[index]), dt);
+		simd::Lane endX = simd::add(x, dx);
+		simd::Lane endY = simd::add(y, dy);
+		simd::Lane lifetime = simd::sub(simd::load(&m_lifetime[index]), dt);
+		simd::Lane length = simd::add(simd::add(simd::mul(dx, dx), simd::mul(dy, dy)), tiny);
+
+		simd::Mask alive = simd::both(
+			simd::both(
+				simd::both(simd::greaterEqual(endX, left), simd::lessEqual(endX, right)),
+				simd::both(simd::greaterEqual(endY, bottom), simd::lessEqual(endY, top))
+			),
+			simd::greater(lifetime, zero)
+		);
+
+		float nearest[simd::LANES];
+		uint32_t struck[simd::LANES];
+		int32_t candidates = 0;
+
+		for (uint32_t target = 0; target < m_targets.size(); target++)
+		{
+			auto& candidate = m_targets[target];
+
+			simd::Lane toX = simd::sub(simd::set(candidate.center.x), x);
+			simd::Lane toY = simd::sub(simd::set(candidate.center.y), y);
+			simd::Lane along = simd::div(simd::add(simd::mul(toX, dx), simd::mul(toY, dy)), length);
+			along = simd::min(simd::max(along, zero), one);
+
+			simd::Lane offsetX = simd::sub(toX, simd::mul(along, dx));
+			simd::Lane offsetY = simd::sub(toY, simd::mul(along, dy));
+			simd::Lane distance = simd::add(simd::mul(offsetX, offsetX), simd::mul(offsetY, offsetY));
+
+			int32_t near = simd::bits(simd::lessEqual(distance, simd::set(candidate.radius * candidate.radius)));
+			if (near == 0)
+			{
+				continue;
+			}
+
+			if (candidates == 0)
+			{
+				fill(nearest, nearest + simd::LANES, NO_HIT);
+			}
+			candidates |= near;
+
+			for (size_t lane = 0; lane < simd::LANES && index + lane < m_size; lane++)
+			{
+				if ((near & (1 << lane)) == 0 || m_owner[index + lane] == target)
+				{
+					continue;
+				}
+
+				auto from = Point2f(m_positionX[index + lane], m_positionY[index + lane]);
+				auto to = from + Point2f(m_velocityX[index + lane], m_velocityY[index + lane]) * timestep;
+
+				for (size_t part = 0; part < candidate.footprint.size; part++)
+				{
+					float time = sweep(from, to, candidate.footprint.parts[part]);
+					if (time < nearest[lane])
+					{
+						nearest[lane] = time;
+						struck[lane] = target;
+					}
+				}
+			}
+		}
+
+		simd::store(&m_positionX[index], endX);
+		simd::store(&m_positionY[index], endY);
+		simd::store(&m_lifetime[index], simd::select(alive, lifetime, dead));
+
+		if (candidates == 0)
+		{
+			continue;
+		}
+
+		for (size_t lane = 0; lane < simd::LANES && index + lane < m_size; lane++)
+		{
+			if (nearest[lane] == NO_HIT)
+			{
+				continue;
+			}
+
+			auto velocity = Point2f(m_velocityX[index + lane], m_velocityY[index + lane]);
+			auto end = Point2f(m_positionX[index + lane], m_positionY[index + lane]);
+
+			ProjectileHit hit =
+			{
+				m_owner[index + lane],
+				struck[lane],
+				end - velocity * ((1.0f - nearest[lane]) * timestep)
+			};
+			m_hits.push_back(hit);
+			m_lifetime[index + lane] = -1.0f;
+		}
+	}
+
+	compact();
+
+	return 0;
+}
+
+const std::vector<ProjectileHit>& ProjectilePool::hits() const
+{
+	return m_hits;
+}
+
+void ProjectilePool::clear()
+{
+	m_size = 0;
+	m_hits.clear();
+}
+
+size_t ProjectilePool::size() const
+{
+	return m_size;
+}
+
+size_t ProjectilePool::capacity() const
+{
+	return m_capacity;
+}
+
+void ProjectilePool::setBorder(const Border border)
+{
+	m_border = border;
+}
+
+Border ProjectilePool::border() const
+{
+	return m_border;
+}
+
+cv::Point2f ProjectilePool::position(size_t index) const
+{
+	return Point2f(m_positionX.at(index), m_positionY.at(index));
+}
+
+cv::Point2f ProjectilePool::velocity(size_t index) const
+{
+	return Point2f(m_velocityX.at(index), m_velocityY.at(index));
+}
+
+float ProjectilePool::lifetime(size_t index) const
+{
+	return m_lifetime.at(index);
+}
+
+uint32_t ProjectilePool::owner(size_t index) const
+{
+	return m_owner.at(index);
+}
+
+float ProjectilePool::sweep(const cv::Point2f from, const cv::Point2f to, const PolygonPoints& polygon)
+{
+	if (polygon.size() < 3)
+	{
+		return NO_HIT;
+	}
+
+	float area = 0.0f;
+	for (size_t index = 0; index < polygon.size(); index++)
+	{
+		auto& a = polygon[index];
+		auto& b = polygon[(index + 1) % polygon.size()];
+		area += a.x * b.y - a.y * b.x;
+	}
+	float orientation = area >= 0.0f ? 1.0f : -1.0f;
+
+	auto direction = to - from;
+	float enter = 0.0f;
+	float exit = 1.0f;
+
+	for (size_t index = 0; index < polygon.size(); index++)
+	{
+		auto& a = polygon[index];
+		auto edge = polygon[(index + 1) % polygon.size()] - a;
+		auto offset = from - a;
+
+		float inside = orientation * (edge.x * offset.y - edge.y * offset.x);
+		float rate = orientation * (edge.x * direction.y - edge.y * direction.x);
+
+		if (rate == 0.0f)
+		{
+			if (inside < 0.0f)
+			{
+				return NO_HIT;
+			}
+			continue;
+		}
+
+		float time = -inside / rate;
+		if (rate > 0.0f)
+		{
+			enter = max(enter, time);
+		}
+		else
+		{
+			exit = min(exit, time);
+		}
+
+		if (enter > exit)
+		{
+			return NO_HIT;
+		}
+	}
+
+	return enter;
+}
+
+void ProjectilePool::prepare(const std::vector<Robot*>& targets)
+{
+	m_targets.resize(targets.size());
+
+	for (size_t index = 0; index < targets.size(); index++)
+	{
+		auto& target = m_targets[index];
+		target.footprint = targets[index]->footprint();
+		target.center = targets[index]->center();
+		target.radius = 0.0f;
+
+		for (size_t part = 0; part < target.footprint.size; part++)
+		{
+			for (auto& point : target.footprint.parts[part])
+			{
+				target.radius = max(target.radius, hypotf(point.x - target.center.x, point.y - target.center.y));
+			}
+		}
+		target.radius += 0.5f;
+	}
+}
+
+void ProjectilePool::compact()
+{
+	size_t index = 0;
+
+	while (index < m_size)
+	{
+		if (m_lifetime[index] > 0.0f)
+		{
+			index++;
+			continue;
+		}
+
+		m_size--;
+		m_positionX[index] = m_positionX[m_size];
+		m_positionY[index] = m_positionY[m_size];
+		m_velocityX[index] = m_velocityX[m_size];
+		m_velocityY[index] = m_velocityY[m_size];
+		m_lifetime[index] = m_lifetime[m_size];
+		m_owner[index] = m_owner[m_size];
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include "robot.h"
+#include "war_robot.h"
+
+#define PROJECTILE_CAPACITY 131072
+
+struct ProjectileHit
+{
+	uint32_t owner;
+	uint32_t target;
+	cv::Point2f point;
+};
+
+// Structure-of-arrays pool of live projectiles. Storage is allocated once for
+// the full capacity, live projectiles are kept packed at the front and dead
+// ones are swap-removed, so spawning never touches the heap. step() advances
+// the pool a lane batch at a time and sweeps each segment against the Border
+// and the footprints of the targets.
+class ProjectilePool
+{
+public:
+	ProjectilePool(
+		const size_t capacity = PROJECTILE_CAPACITY,
+		const Border border = { 1079.0f, 719.0f, 0.0f, 0.0f }
+	);
+	~ProjectilePool() = default;
+
+	int32_t spawn(const cv::Point2f position, const cv::Point2f velocity, const float lifetime, const uint32_t owner);
+	int32_t fire(WarRobot& robot, const uint32_t owner, const float speed = 600.0f, const float lifetime = 2.0f);
+
+	int32_t step(const float timestep, const std::vector<Robot*>& targets);
+	const std::vector<ProjectileHit>& hits() const;
+
+	void clear();
+	size_t size() const;
+	size_t capacity() const;
+
+	void setBorder(const Border border);
+	Border border() const;
+
+	cv::Point2f position(size_t index) const;
+	cv::Point2f velocity(size_t index) const;
+	float lifetime(size_t index) const;
+	uint32_t owner(size_t index) const;
+
+	static float sweep(const cv::Point2f from, const cv::Point2f to, const PolygonPoints& polygon);
+
+private:
+	struct Target
+	{
+		Footprint footprint;
+		cv::Point2f center;
+		float radius;
+	};
+
+	void prepare(const std::vector<Robot*>& targets);
+	void compact();
+
+	size_t m_size;
+	size_t m_capacity;
+	Border m_border;
+
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_velocityX;
+	std::vector<float> m_velocityY;
+	std::vector<float> m_lifetime;
+	std::vector<uint32_t> m_owner;
+
+	std::vector<Target> m_targets;
+	std::vector<ProjectileHit> m_hits;
+};
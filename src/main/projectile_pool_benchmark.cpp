@@ -0,0 +1,38 @@
+#include "benchmark.h"
+#include "projectile_pool.h"
+
+using namespace std;
+using namespace cv;
+
+void benchmarkProjectilePool(Benchmark& benchmark)
+{
+	auto& robots = benchmark.robots();
+	auto area = benchmark.area();
+
+	ProjectilePool projectiles(PROJECTILE_CAPACITY, robots.front().border());
+	vector<Robot*> targets;
+	for (size_t index = 0; index < 8 && index < robots.size(); index++)
+	{
+		targets.push_back(&robots[index]);
+	}
+
+	uint32_t seed = 1;
+	auto random = [&seed]()
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return static_cast<float>(seed >> 8) / 16777216.0f;
+	};
+
+	benchmark.measure("ProjectilePool::step", 1, [area, &projectiles, &targets, &random](size_t)
+	{
+		while (projectiles.size() < 100000)
+		{
+			auto position = Point2f(random() * area.width, random() * area.height);
+			auto velocity = Point2f(random() * 600.0f - 300.0f, random() * 600.0f - 300.0f);
+			projectiles.spawn(position, velocity, 2.0f, UINT32_MAX);
+		}
+
+		projectiles.step(1.0f / 60.0f, targets);
+		return static_cast<float>(projectiles.hits().size());
+	}, 100000);
+}
@@ -0,0 +1,844 @@
+#include "renderer.h"
+#include "profiler.h"
+#include "war_robot.h"
+#include "opencv2/imgproc.hpp"
+
+#include <cstring>
+#include <iomanip>
+#include <random>
+
+#define MARGIN 2
+#define TILE_SIZE 128
+
+using namespace std;
+using namespace cv;
+
+namespace
+{
+	size_t mismatches(const Mat& first, const Mat& second)
+	{
+		size_t count = 0;
+		for (int32_t row = 0; row < first.rows; row++)
+		{
+			const uint8_t* a = first.ptr<uint8_t>(row);
+			const uint8_t* b = second.ptr<uint8_t>(row);
+			for (int32_t column = 0; column < first.cols; column++)
+			{
+				count += memcmp(a + 3 * column, b + 3 * column, 3) != 0 ? 1 : 0;
+			}
+		}
+		return count;
+	}
+
+	float ink(const uint8_t* pixel)
+	{
+		return (3.0f * 0xFF - pixel[0] - pixel[1] - pixel[2]) / (3.0f * 0xFF);
+	}
+
+	// Pixels at least half inked in one frame with no ink at all within one
+	// pixel in the other.
+	size_t strays(const Mat& first, const Mat& second)
+	{
+		size_t count = 0;
+		for (int32_t row = 0; row < first.rows; row++)
+		{
+			for (int32_t column = 0; column < first.cols; column++)
+			{
+				if (ink(first.ptr<uint8_t>(row) + 3 * column) < 0.5f)
+				{
+					continue;
+				}
+
+				bool near = false;
+				for (int32_t y = max(row - 1, 0); y <= min(row + 1, second.rows - 1) && near == false; y++)
+				{
+					for (int32_t x = max(column - 1, 0); x <= min(column + 1, second.cols - 1) && near == false; x++)
+					{
+						near = ink(second.ptr<uint8_t>(y) + 3 * x) > 0.0f;
+					}
+				}
+				count += near == true ? 0 : 1;
+			}
+		}
+		return count;
+	}
+
+	double totalInk(const Mat& frame)
+	{
+		double total = 0.0;
+		for (int32_t row = 0; row < frame.rows; row++)
+		{
+			for (int32_t column = 0; column < frame.cols; column++)
+			{
+				total += ink(frame.ptr<uint8_t>(row) + 3 * column);
+			}
+		}
+		return total;
+	}
+}
+
+Renderer::Renderer(const cv::Size2i area, const cv::Scalar background) :
+	m_area(area),
+	m_background(background),
+	m_invalid(true),
+	m_parallel(true),
+	m_mode(RenderMode::OUTLINE),
+	m_fillColor(0xC0, 0xC0, 0xC0)
+{
+
+}
+
+void Renderer::add(Robot& robot)
+{
+	Entry entry = { &robot, PolygonPoints(), Rect() };
+	m_entries.push_back(entry);
+	m_invalid = true;
+}
+
+void Renderer::clear()
+{
+	m_entries.clear();
+	m_invalid = true;
+}
+
+size_t Renderer::size() const
+{
+	return m_entries.size();
+}
+
+void Renderer::setArea(const cv::Size2i area)
+{
+	if (area == m_area)
+	{
+		return;
+	}
+
+	m_area = area;
+	m_invalid = true;
+}
+
+cv::Size2i Renderer::area() const
+{
+	return m_area;
+}
+
+void Renderer::setBackground(const cv::Mat& image)
+{
+	m_backgroundImage = image;
+	m_invalid = true;
+}
+
+void Renderer::setParallel(const bool parallel)
+{
+	m_parallel = parallel;
+}
+
+bool Renderer::parallel() const
+{
+	return m_parallel;
+}
+
+void Renderer::setMode(const RenderMode mode)
+{
+	if (mode == m_mode)
+	{
+		return;
+	}
+
+	m_mode = mode;
+	m_invalid = true;
+}
+
+RenderMode Renderer::mode() const
+{
+	return m_mode;
+}
+
+void Renderer::setFillColor(const cv::Scalar color)
+{
+	m_fillColor = color;
+	m_invalid = true;
+}
+
+cv::Scalar Renderer::fillColor() const
+{
+	return m_fillColor;
+}
+
+void Renderer::invalidate()
+{
+	m_invalid = true;
+}
+
+int32_t Renderer::render()
+{
+	PROFILE_SCOPE("Renderer::render");
+
+	m_dirtyRects.clear();
+
+	if (m_frame.rows != m_area.height || m_frame.cols != m_area.width)
+	{
+		m_frame.create(m_area, CV_8UC3);
+		m_invalid = true;
+	}
+
+	for (auto& entry : m_entries)
+	{
+		auto points = entry.robot->boundaryPoints();
+
+		bool moved = points.size() != entry.points.size();
+		for (size_t index = 0; moved == false && index < points.size(); index++)
+		{
+			moved = points[index] != entry.points[index];
+		}
+
+		if (moved == false && m_invalid == false)
+		{
+			continue;
+		}
+
+		auto bounds = screenBounds(points);
+		addDirtyRect(entry.bounds);
+		addDirtyRect(bounds);
+
+		entry.points = points;
+		entry.bounds = bounds;
+	}
+
+	if (m_invalid == true)
+	{
+		m_dirtyRects.clear();
+		m_dirtyRects.push_back(Rect(0, 0, m_area.width, m_area.height));
+		m_invalid = false;
+	}
+
+	PROFILE_COUNT("Renderer::dirtyRects", m_dirtyRects.size());
+
+	if (m_dirtyRects.empty() == true)
+	{
+		return 0;
+	}
+
+	return renderTiles();
+}
+
+int32_t Renderer::renderTiles()
+{
+	// Not parallel, the same rasterizer runs over one tile covering the frame.
+	m_tileSize = m_parallel == true ? Size2i(TILE_SIZE, TILE_SIZE) : m_area;
+	m_tiles = Size2i((m_area.width + m_tileSize.width - 1) / m_tileSize.width, (m_area.height + m_tileSize.height - 1) / m_tileSize.height);
+	m_bins.resize(static_cast<size_t>(m_tiles.area()));
+	for (auto& bin : m_bins)
+	{
+		bin.clear();
+	}
+	m_vertices.clear();
+	m_positions.clear();
+	m_polygons.clear();
+
+	for (auto& entry : m_entries)
+	{
+		bool dirty = false;
+		for (auto& rect : m_dirtyRects)
+		{
+			dirty = dirty || (entry.bounds & rect).area() > 0;
+		}
+
+		if (dirty == false)
+		{
+			continue;
+		}
+
+		if (entry.robot->area() != m_area)
+		{
+			return -1;
+		}
+
+		binPolygons(entry.robot->outline());
+	}
+
+	auto renderRange = [this](const Range& range)
+	{
+		for (int32_t tile = range.start; tile < range.end; tile++)
+		{
+			renderTile(static_cast<size_t>(tile));
+		}
+	};
+
+	if (m_parallel == true)
+	{
+		parallel_for_(Range(0, m_tiles.area()), renderRange);
+	}
+	else
+	{
+		renderRange(Range(0, m_tiles.area()));
+	}
+
+	return 0;
+}
+
+int32_t Renderer::renderReference()
+{
+	PROFILE_SCOPE("Renderer::renderReference");
+
+	if (m_frame.rows != m_area.height || m_frame.cols != m_area.width)
+	{
+		m_frame.create(m_area, CV_8UC3);
+	}
+
+	// The next render() has nothing incremental to build on.
+	m_invalid = true;
+	m_dirtyRects.clear();
+	m_dirtyRects.push_back(Rect(0, 0, m_area.width, m_area.height));
+	clearRect(m_dirtyRects.front());
+
+	auto black = Scalar(0x00, 0x00, 0x00);
+
+	for (auto& entry : m_entries)
+	{
+		auto& robot = *entry.robot;
+		if (robot.area() != m_area)
+		{
+			return -1;
+		}
+
+		if (m_mode == RenderMode::OUTLINE)
+		{
+			if (robot.draw(m_frame) != 0)
+			{
+				return -1;
+			}
+			continue;
+		}
+
+		Outline outline = robot.outline();
+
+		for (size_t part = 0; part < outline.size; part++)
+		{
+			auto& points = outline.parts[part];
+			if (points.empty() == true)
+			{
+				continue;
+			}
+
+			if (m_mode == RenderMode::FILLED)
+			{
+				Point vertices[POLYGON_CAPACITY];
+				for (size_t index = 0; index < points.size(); index++)
+				{
+					vertices[index] = Point(cvRound(points[index].x), cvRound(static_cast<float>(m_area.height) - 1.0f - points[index].y));
+				}
+
+				fillConvexPoly(m_frame, vertices, static_cast<int>(points.size()), m_fillColor);
+				for (size_t index = 0; index < points.size(); index++)
+				{
+					line(m_frame, vertices[index], vertices[(index + 1) % points.size()], black);
+				}
+				continue;
+			}
+
+			auto point = [this](const Point2f point)
+			{
+				return Point(cvRound(point.x * 16.0f), cvRound((static_cast<float>(m_area.height) - 1.0f - point.y) * 16.0f));
+			};
+
+			for (size_t index = 0; index < points.size(); index++)
+			{
+				line(m_frame, point(points[index]), point(points[(index + 1) % points.size()]), black, 1, LINE_AA, 4);
+			}
+		}
+	}
+
+	return 0;
+}
+
+void Renderer::binPolygons(const Outline& outline)
+{
+	for (size_t part = 0; part < outline.size; part++)
+	{
+		auto& points = outline.parts[part];
+		if (points.empty() == true)
+		{
+			continue;
+		}
+
+		Polygon polygon = { m_vertices.size(), points.size(), Rect() };
+
+		int32_t left = INT32_MAX;
+		int32_t right = INT32_MIN;
+		int32_t top = INT32_MAX;
+		int32_t bottom = INT32_MIN;
+
+		for (auto& point : points)
+		{
+			auto position = Point2f(point.x, static_cast<float>(m_area.height) - 1.0f - point.y);
+			auto vertex = Point(cvRound(position.x), cvRound(position.y));
+			m_vertices.push_back(vertex);
+			m_positions.push_back(position);
+
+			left = min(left, vertex.x);
+			right = max(right, vertex.x);
+			top = min(top, vertex.y);
+			bottom = max(bottom, vertex.y);
+		}
+
+		int32_t margin = m_mode == RenderMode::ANTIALIASED ? 1 : 0;
+		polygon.bounds = Rect(left - margin, top - margin, right - left + 1 + 2 * margin, bottom - top + 1 + 2 * margin) &
+			Rect(0, 0, m_area.width, m_area.height);
+		if (polygon.bounds.area() == 0)
+		{
+			continue;
+		}
+
+		auto index = static_cast<uint32_t>(m_polygons.size());
+		m_polygons.push_back(polygon);
+
+		for (int32_t tileY = polygon.bounds.y / m_tileSize.height; tileY <= (polygon.bounds.br().y - 1) / m_tileSize.height; tileY++)
+		{
+			for (int32_t tileX = polygon.bounds.x / m_tileSize.width; tileX <= (polygon.bounds.br().x - 1) / m_tileSize.width; tileX++)
+			{
+				m_bins[tileY * m_tiles.width + tileX].push_back(index);
+			}
+		}
+	}
+}
+
+void Renderer::renderTile(const size_t tile)
+{
+	auto rect = tileRect(tile);
+
+	auto black = Scalar(0x00, 0x00, 0x00);
+	uint8_t color[3] =
+	{
+		saturate_cast<uint8_t>(black[0]),
+		saturate_cast<uint8_t>(black[1]),
+		saturate_cast<uint8_t>(black[2])
+	};
+
+	uint8_t fill[3] =
+	{
+		saturate_cast<uint8_t>(m_fillColor[0]),
+		saturate_cast<uint8_t>(m_fillColor[1]),
+		saturate_cast<uint8_t>(m_fillColor[2])
+	};
+
+	// Dirty rects never overlap, and every pixel is drawn only inside the one
+	// that cleared it, so antialiased edges blend exactly once per frame.
+	for (auto& dirtyRect : m_dirtyRects)
+	{
+		auto clip = dirtyRect & rect;
+		if (clip.area() == 0)
+		{
+			continue;
+		}
+
+		clearRect(clip);
+
+		auto edge = [this, &clip, &color](const Point from, const Point to)
+		{
+			auto bounds = Rect(min(from.x, to.x), min(from.y, to.y), abs(to.x - from.x) + 1, abs(to.y - from.y) + 1);
+			if ((bounds & clip).area() == 0)
+			{
+				return;
+			}
+
+			LineIterator iterator(m_frame, from, to, 8, true);
+			for (int32_t index = 0; index < iterator.count; index++, ++iterator)
+			{
+				if (clip.contains(iterator.pos()) == true)
+				{
+					uint8_t* pixel = *iterator;
+					pixel[0] = color[0];
+					pixel[1] = color[1];
+					pixel[2] = color[2];
+				}
+			}
+		};
+
+		for (auto index : m_bins[tile])
+		{
+			auto& polygon = m_polygons[index];
+			if ((polygon.bounds & clip).area() == 0)
+			{
+				continue;
+			}
+
+			if (m_mode == RenderMode::ANTIALIASED)
+			{
+				const Point2f* positions = m_positions.data() + polygon.first;
+
+				smoothLine(positions[0], positions[polygon.size - 1], clip, color);
+				for (size_t vertex = 1; vertex < polygon.size; vertex++)
+				{
+					smoothLine(positions[vertex - 1], positions[vertex], clip, color);
+				}
+				continue;
+			}
+
+			if (m_mode == RenderMode::FILLED)
+			{
+				fillPolygon(polygon, clip, fill);
+			}
+
+			const Point* vertices = m_vertices.data() + polygon.first;
+
+			edge(vertices[0], vertices[polygon.size - 1]);
+			for (size_t vertex = 1; vertex < polygon.size; vertex++)
+			{
+				edge(vertices[vertex - 1], vertices[vertex]);
+			}
+		}
+	}
+}
+
+void Renderer::fillPolygon(const Polygon& polygon, const cv::Rect& clip, const uint8_t color[3])
+{
+	auto rows = polygon.bounds & clip;
+	if (rows.area() == 0)
+	{
+		return;
+	}
+
+	// Walks both chains down from the top vertex with the 16.16 fixed-point
+	// steps fillConvexPoly uses, so every span matches it; the spans are only
+	// written inside the clip.
+	const int64_t one = static_cast<int64_t>(1) << 16;
+	const Point* vertices = m_vertices.data() + polygon.first;
+	const int32_t count = static_cast<int32_t>(polygon.size);
+	if (count < 3)
+	{
+		return;
+	}
+
+	int32_t top = 0;
+	for (int32_t index = 1; index < count; index++)
+	{
+		if (vertices[index].y < vertices[top].y)
+		{
+			top = index;
+		}
+	}
+
+	struct Edge
+	{
+		int32_t index;
+		int32_t direction;
+		int64_t x;
+		int64_t dx;
+		int32_t end;
+	};
+
+	Edge edges[2] =
+	{
+		{ top, 1, -one, 0, vertices[top].y },
+		{ top, count - 1, -one, 0, vertices[top].y }
+	};
+
+	int32_t remaining = count;
+	int32_t last = min(polygon.bounds.br().y - 1, m_area.height - 1);
+
+	for (int32_t y = vertices[top].y; y <= last && y < rows.br().y; y++)
+	{
+		for (auto& edge : edges)
+		{
+			if (y < edge.end)
+			{
+				continue;
+			}
+
+			int32_t from = edge.index;
+			int32_t to = (from + edge.direction) % count;
+			while (remaining-- > 0)
+			{
+				if (vertices[to].y > y)
+				{
+					int64_t height = vertices[to].y - y;
+					int64_t width = (static_cast<int64_t>(vertices[to].x) - vertices[from].x) * one;
+					edge.end = vertices[to].y;
+					edge.dx = (width * 2 + height) / (2 * height);
+					edge.x = static_cast<int64_t>(vertices[from].x) * one;
+					edge.index = to;
+					break;
+				}
+				from = to;
+				to = (to + edge.direction) % count;
+			}
+		}
+
+		if (remaining < 0)
+		{
+			break;
+		}
+
+		if (y >= rows.y)
+		{
+			auto& left = edges[0].x > edges[1].x ? edges[1] : edges[0];
+			auto& right = edges[0].x > edges[1].x ? edges[0] : edges[1];
+			int32_t first = max(static_cast<int32_t>((left.x + one / 2) >> 16), rows.x);
+			int32_t end = min(static_cast<int32_t>((right.x + one / 2) >> 16), rows.br().x - 1);
+
+			uint8_t* row = m_frame.ptr<uint8_t>(y);
+			for (int32_t x = first; x <= end; x++)
+			{
+				row[3 * x + 0] = color[0];
+				row[3 * x + 1] = color[1];
+				row[3 * x + 2] = color[2];
+			}
+		}
+
+		edges[0].x += edges[0].dx;
+		edges[1].x += edges[1].dx;
+	}
+}
+
+void Renderer::smoothLine(cv::Point2f from, cv::Point2f to, const cv::Rect& clip, const uint8_t color[3])
+{
+	bool steep = fabs(to.y - from.y) > fabs(to.x - from.x);
+	if (steep == true)
+	{
+		swap(from.x, from.y);
+		swap(to.x, to.y);
+	}
+	if (from.x > to.x)
+	{
+		swap(from, to);
+	}
+
+	auto plot = [this, &clip, color, steep](const int32_t major, const int32_t minor, const float coverage)
+	{
+		int32_t x = steep == true ? minor : major;
+		int32_t y = steep == true ? major : minor;
+		if (coverage <= 0.0f || clip.contains(Point(x, y)) == false)
+		{
+			return;
+		}
+
+		uint8_t* pixel = m_frame.ptr<uint8_t>(y) + 3 * x;
+		for (int32_t channel = 0; channel < 3; channel++)
+		{
+			pixel[channel] = saturate_cast<uint8_t>(pixel[channel] + (color[channel] - pixel[channel]) * coverage);
+		}
+	};
+
+	auto fraction = [](const float value)
+	{
+		return value - floorf(value);
+	};
+
+	float dx = to.x - from.x;
+	float gradient = dx == 0.0f ? 1.0f : (to.y - from.y) / dx;
+
+	int32_t first = cvRound(from.x);
+	float firstY = from.y + gradient * (first - from.x);
+	float firstGap = 1.0f - fraction(from.x + 0.5f);
+	plot(first, cvFloor(firstY), (1.0f - fraction(firstY)) * firstGap);
+	plot(first, cvFloor(firstY) + 1, fraction(firstY) * firstGap);
+
+	int32_t last = cvRound(to.x);
+	float lastY = to.y + gradient * (last - to.x);
+	float lastGap = fraction(to.x + 0.5f);
+	plot(last, cvFloor(lastY), (1.0f - fraction(lastY)) * lastGap);
+	plot(last, cvFloor(lastY) + 1, fraction(lastY) * lastGap);
+
+	int32_t low = steep == true ? clip.y : clip.x;
+	int32_t high = steep == true ? clip.br().y - 1 : clip.br().x - 1;
+	int32_t begin = max(first + 1, low);
+	int32_t end = min(last - 1, high);
+
+	// Each column is computed from the first so a clipped line plots exactly
+	// what the unclipped one would.
+	for (int32_t x = begin; x <= end; x++)
+	{
+		float y = firstY + gradient * (x - first);
+		plot(x, cvFloor(y), 1.0f - fraction(y));
+		plot(x, cvFloor(y) + 1, fraction(y));
+	}
+}
+
+cv::Rect Renderer::tileRect(const size_t tile) const
+{
+	int32_t tileX = static_cast<int32_t>(tile) % m_tiles.width;
+	int32_t tileY = static_cast<int32_t>(tile) / m_tiles.width;
+
+	return Rect(tileX * m_tileSize.width, tileY * m_tileSize.height, m_tileSize.width, m_tileSize.height) & Rect(0, 0, m_area.width, m_area.height);
+}
+
+void Renderer::clearRect(const cv::Rect rect)
+{
+	if (rect.area() == 0)
+	{
+		return;
+	}
+
+	if (m_backgroundImage.size() == m_frame.size() && m_backgroundImage.type() == m_frame.type())
+	{
+		m_backgroundImage(rect).copyTo(m_frame(rect));
+	}
+	else
+	{
+		m_frame(rect).setTo(m_background);
+	}
+}
+
+bool Renderer::changed() const
+{
+	return m_dirtyRects.empty() == false;
+}
+
+const std::vector<cv::Rect>& Renderer::dirtyRects() const
+{
+	return m_dirtyRects;
+}
+
+const cv::Mat& Renderer::frame() const
+{
+	return m_frame;
+}
+
+int32_t Renderer::validate(std::ostream& stream, const uint32_t robots, const uint32_t frames)
+{
+	int32_t result = 0;
+	const char keys[] = "wasdqezx.,[]";
+	const Size2i area(1080, 720);
+
+	for (auto mode : { RenderMode::OUTLINE, RenderMode::FILLED, RenderMode::ANTIALIASED })
+	{
+		mt19937 random(1);
+		uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		vector<WarRobot> fleet;
+		fleet.reserve(robots);
+		for (uint32_t index = 0; index < robots; index++)
+		{
+			auto robot = WarRobot(60, 120, { 10, 40 }, CombatModule(), Point2f(0, 0), static_cast<float>(2.0 * M_PI) * unit(random));
+			robot.setSpeed(SPEED);
+			robot.setAngularSpeed(ANGULAR_SPEED);
+			robot.combatModule().setAngularSpeed(0.2f);
+			robot.setCenter(100.0f + 880.0f * unit(random), 100.0f + 520.0f * unit(random));
+			fleet.push_back(robot);
+		}
+
+		// Incremental serial and tiled frames must match the OpenCV reference,
+		// and antialiased ones, which draw different lines, a full redraw.
+		Renderer serial(area);
+		Renderer tiled(area);
+		Renderer full(area);
+		Renderer reference(area);
+		serial.setParallel(false);
+		for (auto renderer : { &serial, &tiled, &full, &reference })
+		{
+			renderer->setMode(mode);
+			for (auto& robot : fleet)
+			{
+				renderer->add(robot);
+			}
+		}
+
+		size_t worst = 0;
+		size_t stray = 0;
+		double inkError = 0.0;
+		for (uint32_t frame = 0; frame < frames; frame++)
+		{
+			for (auto& robot : fleet)
+			{
+				robot.doSomething(keys[random() % (sizeof(keys) - 1)]);
+			}
+
+			serial.render();
+			tiled.render();
+			reference.renderReference();
+
+			if (mode != RenderMode::ANTIALIASED)
+			{
+				worst = max(worst, max(mismatches(serial.frame(), reference.frame()), mismatches(tiled.frame(), reference.frame())));
+				continue;
+			}
+
+			full.invalidate();
+			full.render();
+			worst = max(worst, max(mismatches(serial.frame(), full.frame()), mismatches(tiled.frame(), full.frame())));
+
+			double expected = totalInk(reference.frame());
+			inkError = max(inkError, fabs(totalInk(tiled.frame()) - expected) / max(expected, 1.0));
+			stray = max(stray, max(strays(tiled.frame(), reference.frame()), strays(reference.frame(), tiled.frame())));
+		}
+
+		const char* name = mode == RenderMode::FILLED ? "render/filled" : (mode == RenderMode::ANTIALIASED ? "render/antialiased" : "render/outline");
+		bool passed = worst == 0;
+		stream << left << setw(24) << name << right << setw(12) << worst << " == 0" << (passed == true ? "  ok" : "  FAILED") << endl;
+
+		if (mode == RenderMode::ANTIALIASED)
+		{
+			bool inked = inkError <= RENDER_INK_TOLERANCE;
+			stream << left << setw(24) << "render/antialiased/ink" << right << setw(12) << inkError << " <= " << RENDER_INK_TOLERANCE << (inked == true ? "  ok" : "  FAILED") << endl;
+
+			bool placed = stray == 0;
+			stream << left << setw(24) << "render/antialiased/stray" << right << setw(12) << stray << " == 0" << (placed == true ? "  ok" : "  FAILED") << endl;
+
+			passed = passed == true && inked == true && placed == true;
+		}
+
+		if (passed == false)
+		{
+			result = -1;
+		}
+	}
+
+	return result;
+}
+
+cv::Rect Renderer::screenBounds(const PolygonPoints& points) const
+{
+	if (points.empty() == true)
+	{
+		return Rect();
+	}
+
+	float left = FLT_MAX;
+	float right = -FLT_MAX;
+	float top = FLT_MAX;
+	float bottom = -FLT_MAX;
+
+	for (auto& point : points)
+	{
+		float y = static_cast<float>(m_area.height) - 1.0f - point.y;
+		left = min(left, point.x);
+		right = max(right, point.x);
+		top = min(top, y);
+		bottom = max(bottom, y);
+	}
+
+	auto bounds = Rect(
+		cvFloor(left) - MARGIN,
+		cvFloor(top) - MARGIN,
+		cvCeil(right) - cvFloor(left) + 2 * MARGIN + 1,
+		cvCeil(bottom) - cvFloor(top) + 2 * MARGIN + 1
+	);
+
+	return bounds & Rect(0, 0, m_area.width, m_area.height);
+}
+
+void Renderer::addDirtyRect(const cv::Rect rect)
+{
+	if (rect.area() == 0)
+	{
+		return;
+	}
+
+	auto merged = rect;
+	for (size_t index = 0; index < m_dirtyRects.size();)
+	{
+		if ((m_dirtyRects[index] & merged).area() > 0)
+		{
+			merged = merged | m_dirtyRects[index];
+			m_dirtyRects.erase(m_dirtyRects.begin() + index);
+			index = 0;
+		}
+		else
+		{
+			index++;
+		}
+	}
+
+	m_dirtyRects.push_back(merged);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include "robot.h"
+
+#define RENDER_INK_TOLERANCE 0.25
+
+enum class RenderMode
+{
+	OUTLINE,
+	FILLED,
+	ANTIALIASED
+};
+
+// Redraws only the dirty rectangles of a persistent frame. render() bins the
+// outline polygons of dirty robots into screen tiles and rasterizes them in
+// parallel, or as one full-frame tile when not parallel. renderReference()
+// redraws the whole frame with the per-edge OpenCV calls instead: Robot::draw
+// for OUTLINE, fillConvexPoly and cv::line for FILLED and cv::line with
+// LINE_AA for ANTIALIASED. validate() requires OUTLINE and FILLED frames to
+// match it pixel for pixel. ANTIALIASED frames use Wu lines, so they only
+// have to stay within RENDER_INK_TOLERANCE of its ink and within a pixel of
+// its lines.
+class Renderer
+{
+public:
+	Renderer(
+		const cv::Size2i area = cv::Size2i(1080, 720),
+		const cv::Scalar background = cv::Scalar(0xFF, 0xFF, 0xFF)
+	);
+	~Renderer() = default;
+
+	void add(Robot& robot);
+	void clear();
+	size_t size() const;
+
+	void setArea(const cv::Size2i area);
+	cv::Size2i area() const;
+
+	void setBackground(const cv::Mat& image);
+
+	void setParallel(const bool parallel);
+	bool parallel() const;
+
+	void setMode(const RenderMode mode);
+	RenderMode mode() const;
+
+	void setFillColor(const cv::Scalar color);
+	cv::Scalar fillColor() const;
+
+	void invalidate();
+	int32_t render();
+	int32_t renderReference();
+
+	bool changed() const;
+	const std::vector<cv::Rect>& dirtyRects() const;
+	const cv::Mat& frame() const;
+
+	static int32_t validate(std::ostream& stream, const uint32_t robots = 64, const uint32_t frames = 64);
+
+private:
+	struct Entry
+	{
+		Robot* robot;
+		PolygonPoints points;
+		cv::Rect bounds;
+	};
+
+	struct Polygon
+	{
+		size_t first;
+		size_t size;
+		cv::Rect bounds;
+	};
+
+	cv::Rect screenBounds(const PolygonPoints& points) const;
+	void addDirtyRect(const cv::Rect rect);
+	void clearRect(const cv::Rect rect);
+
+	int32_t renderTiles();
+	void binPolygons(const Outline& outline);
+	void renderTile(const size_t tile);
+	void fillPolygon(const Polygon& polygon, const cv::Rect& clip, const uint8_t color[3]);
+	void smoothLine(cv::Point2f from, cv::Point2f to, const cv::Rect& clip, const uint8_t color[3]);
+	cv::Rect tileRect(const size_t tile) const;
+
+	cv::Size2i m_area;
+	cv::Scalar m_background;
+	cv::Mat m_backgroundImage;
+	cv::Mat m_frame;
+	std::vector<Entry> m_entries;
+	std::vector<cv::Rect> m_dirtyRects;
+	bool m_invalid;
+	bool m_parallel;
+	RenderMode m_mode;
+	cv::Scalar m_fillColor;
+
+	cv::Size2i m_tileSize;
+	cv::Size2i m_tiles;
+	std::vector<cv::Point> m_vertices;
+	std::vector<cv::Point2f> m_positions;
+	std::vector<Polygon> m_polygons;
+	std::vector<std::vector<uint32_t>> m_bins;
+};
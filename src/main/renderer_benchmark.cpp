@@ -0,0 +1,47 @@
+#include "benchmark.h"
+#include "renderer.h"
+
+using namespace std;
+using namespace cv;
+
+void benchmarkRenderer(Benchmark& benchmark)
+{
+	auto& robots = benchmark.robots();
+
+	for (auto mode : { RenderMode::OUTLINE, RenderMode::FILLED, RenderMode::ANTIALIASED })
+	{
+		const char* suffix = mode == RenderMode::FILLED ? "/filled" : (mode == RenderMode::ANTIALIASED ? "/antialiased" : "");
+
+		for (auto parallel : { false, true })
+		{
+			auto renderer = Renderer(benchmark.area());
+			renderer.setParallel(parallel);
+			renderer.setMode(mode);
+			for (auto& robot : robots)
+			{
+				renderer.add(robot);
+			}
+
+			string name = parallel == true ? "Renderer::render/tiles" : "Renderer::render/serial";
+
+			benchmark.measure(name + suffix, 1, [&renderer](size_t)
+			{
+				renderer.invalidate();
+				return static_cast<float>(renderer.render());
+			}, robots.size());
+		}
+
+		// The same scene drawn edge by edge with the OpenCV calls.
+		auto reference = Renderer(benchmark.area());
+		reference.setMode(mode);
+		for (auto& robot : robots)
+		{
+			reference.add(robot);
+		}
+
+		benchmark.measure(string("Renderer::renderReference") + suffix, 1, [&reference](size_t)
+		{
+			return static_cast<float>(reference.renderReference());
+		}, robots.size());
+	}
+}
@@ -1,7 +1,13 @@
 #include "robot.h"
+#include "obstacle_map.h"
+#include "profiler.h"
+#include "fast_math.h"
 #include "opencv2/imgproc.hpp"
 
 #define ZERO 0.000001
+#define SWEEP_ITERATIONS 32
+#define SWEEP_TOLERANCE 0.01f
+#define SWEEP_STEP 0.03125f
 
 using namespace std;
 using namespace cv;
@@ -14,13 +20,13 @@ Robot::Robot(
 	const float angle, 
 	const float speed, const float angularSpeed
 ) :
+	m_transform(center, angle),
 	m_width(width),
 	m_length(length),
 	m_wheel(wheel),
-	m_center(center),
-	m_angle(angle),
 	m_speed(speed),
-	m_angularSpeed(speed)
+	m_angularSpeed(speed),
+	m_obstacles(nullptr)
 {
 	auto white = Scalar(0xFF, 0xFF, 0xFF);
 	auto size = Size(1080, 720);
@@ -29,7 +35,45 @@ Robot::Robot(
 	setArea(area);
 	setCenter(area);
 
-	m_boundaryPoints = boundaryPoints();
+	m_footprint.setLocal(
+	{
+		Point2f( m_length / 2.0f,  (m_width + 3.0f * m_wheel.width) / 2.0f),
+		Point2f(-m_length / 2.0f,  (m_width + 3.0f * m_wheel.width) / 2.0f),
+		Point2f(-m_length / 2.0f, -(m_width + 3.0f * m_wheel.width) / 2.0f),
+		Point2f( m_length / 2.0f, -(m_width + 3.0f * m_wheel.width) / 2.0f)
+	});
+
+	m_hull.setLocal(
+	{
+		Point2f( m_length / 2.0f,  m_width / 2.0f),
+		Point2f(-m_length / 2.0f,  m_width / 2.0f),
+		Point2f(-m_length / 2.0f, -m_width / 2.0f),
+		Point2f( m_length / 2.0f, -m_width / 2.0f)
+	});
+
+	Point2f wheelCenter[] =
+	{
+		Point2f( (m_length - m_wheel.diameter) / 2.0f,  (m_width / 2.0f + m_wheel.width)),
+		Point2f(-(m_length - m_wheel.diameter) / 2.0f,  (m_width / 2.0f + m_wheel.width)),
+		Point2f(-(m_length - m_wheel.diameter) / 2.0f, -(m_width / 2.0f + m_wheel.width)),
+		Point2f( (m_length - m_wheel.diameter) / 2.0f, -(m_width / 2.0f + m_wheel.width))
+	};
+
+	for (int32_t index = 0; index < 4; index++)
+	{
+		auto wheelPoint = [&wheelCenter, index](const float x, const float y)
+		{
+			return Point2f(x + wheelCenter[index].x, y + wheelCenter[index].y);
+		};
+
+		m_wheels[index].setLocal(
+		{
+			wheelPoint(-m_wheel.diameter / 2.0f,  m_wheel.width / 2.0f),
+			wheelPoint(-m_wheel.diameter / 2.0f, -m_wheel.width / 2.0f),
+			wheelPoint( m_wheel.diameter / 2.0f, -m_wheel.width / 2.0f),
+			wheelPoint( m_wheel.diameter / 2.0f,  m_wheel.width / 2.0f)
+		});
+	}
 }
 
 void Robot::setSpeed(const float speed)
@@ -85,8 +129,7 @@ Size2i Robot::area() const
 
 int32_t Robot::setCenter(float centerX, float centerY)
 {
-	m_center.x = centerX;
-	m_center.y = centerY;
+	m_transform.setTranslation(Point2f(centerX, centerY));
 
 	return 0;
 }
@@ -98,15 +141,23 @@ int32_t Robot::setCenter(cv::Mat image)
 		return -1;
 	}
 
-	m_center.x = static_cast<float>(image.cols / 2.0);
-	m_center.y = static_cast<float>(image.rows / 2.0);
+	auto center = Point2f();
+	center.x = static_cast<float>(image.cols / 2.0);
+	center.y = static_cast<float>(image.rows / 2.0);
+
+	m_transform.setTranslation(center);
 
 	return 0;
 }
 
 Point2f Robot::center() const
 {
-	return m_center;
+	return m_transform.translation();
+}
+
+void Robot::setAngle(const float angle)
+{
+	m_transform.setAngle(angle);
 }
 
 void Robot::setBorder(const Border border)
@@ -119,33 +170,45 @@ Border Robot::border() const
 	return m_border;
 }
 
+void Robot::setObstacles(const ObstacleMap* obstacles)
+{
+	m_obstacles = obstacles;
+}
+
+const ObstacleMap* Robot::obstacles() const
+{
+	return m_obstacles;
+}
+
 int32_t Robot::move(Direction direction)
 {
 	float distance = calculateDisplacement(direction);
+	auto center = m_transform.translation();
+	float angle = m_transform.angle();
 
 	switch (direction)
 	{
 	case Direction::FORWARD:
-		m_center.x += distance * cosf(m_angle);
-		m_center.y += distance * sinf(m_angle);
+		center.x += distance * cosf(angle);
+		center.y += distance * sinf(angle);
 		break;
 	case Direction::BACK:
-		m_center.x -= distance * cosf(m_angle);
-		m_center.y -= distance * sinf(m_angle);
+		center.x -= distance * cosf(angle);
+		center.y -= distance * sinf(angle);
 		break;
 	case Direction::LEFT:
-		m_center.x -= distance * sinf(m_angle);
-		m_center.y += distance * cosf(m_angle);
+		center.x -= distance * sinf(angle);
+		center.y += distance * cosf(angle);
 		break;
 	case Direction::RIGHT:
-		m_center.x += distance * sinf(m_angle);
-		m_center.y -= distance * cosf(m_angle);
+		center.x += distance * sinf(angle);
+		center.y -= distance * cosf(angle);
 		break;
 	default:
 		return -1;
 	}
 
-	m_boundaryPoints = boundaryPoints();
+	m_transform.setTranslation(center);
 
 	if (distance < m_speed)
 	{
@@ -162,17 +225,15 @@ int32_t Robot::rotate(Rotation rotation)
 	switch (rotation)
 	{
 	case Rotation::CLOCKWISE:
-		m_angle -= angle;
+		m_transform.setAngle(m_transform.angle() - angle);
 		break;
 	case Rotation::COUNTER_CLOCKWISE:
-		m_angle += angle;
+		m_transform.setAngle(m_transform.angle() + angle);
 		break;
 	default:
 		return -1;
 	}
 
-	m_boundaryPoints = boundaryPoints();
-
 	if (angle < m_angularSpeed)
 	{
 		return -2;
@@ -183,14 +244,29 @@ int32_t Robot::rotate(Rotation rotation)
 
 int32_t Robot::go(Direction direction, Rotation rotation)
 {
-	move(direction);
-	rotate(rotation);
+	float fraction = calculateSweep(direction, rotation);
+	auto displacement = heading(direction) * m_speed;
+	float angularDisplacement = (static_cast<int32_t>(rotation) * 2.0f - 1.0f) * m_angularSpeed;
+
+	auto center = m_transform.translation();
+	center.x += fraction * displacement.x;
+	center.y += fraction * displacement.y;
+
+	m_transform.setTranslation(center);
+	m_transform.setAngle(m_transform.angle() + fraction * angularDisplacement);
+
+	if (fraction < 1.0f)
+	{
+		return -2;
+	}
 
 	return 0;
 }
 
 int32_t Robot::draw(cv::Mat &image)
 {
+	PROFILE_SCOPE("Robot::draw");
+
 	if (image.empty() == true)
 	{
 		return -1;
@@ -201,56 +277,26 @@ int32_t Robot::draw(cv::Mat &image)
 		return -2;
 	}
 
-	auto point = [this](const Point2f poligonCenter, const float x, const float y)
+	auto point = [this](const Point2f point)
 	{
-		auto point = cv::Point2f();
-		point.x = center().x + (x + poligonCenter.x) * cosf(angle()) - (y + poligonCenter.y) * sinf(angle());
-		point.y = center().y + (x + poligonCenter.x) * sinf(angle()) + (y + poligonCenter.y) * cosf(angle());
-
-		point.y = static_cast<float>(m_area.height) - 1.0f - point.y;
-		return point;
+		return Point2f(point.x, static_cast<float>(m_area.height) - 1.0f - point.y);
 	};
 
-	auto poligon = [](cv::Mat& image, vector<Point2f>& poligon, const Scalar& color)
+	auto poligon = [point](cv::Mat& image, const PolygonPoints& poligon, const Scalar& color)
 	{
-		line(image, poligon.front(), poligon.back(), color);
+		line(image, point(poligon.front()), point(poligon.back()), color);
 		for (int32_t index = 1; index < poligon.size(); index++)
 		{
-			line(image, poligon.at(index - 1), poligon.at(index), color);
+			line(image, point(poligon[index - 1]), point(poligon[index]), color);
 		}
 	};
 
 	auto black = Scalar(0x00, 0x00, 0x00);
 
-	vector<Point2f> hull =
-	{
-		point(Point2f(),  m_length / 2.0f,  m_width / 2.0f),
-		point(Point2f(), -m_length / 2.0f,  m_width / 2.0f),
-		point(Point2f(), -m_length / 2.0f, -m_width / 2.0f),
-		point(Point2f(),  m_length / 2.0f, -m_width / 2.0f)
-	};
-
-	poligon(image, hull, black);
-
-	vector<Point2f> wheelCenter =
-	{
-		Point2f( (m_length - m_wheel.diameter) / 2.0f,  (m_width / 2.0f + m_wheel.width)),
-		Point2f(-(m_length - m_wheel.diameter) / 2.0f,  (m_width / 2.0f + m_wheel.width)),
-		Point2f(-(m_length - m_wheel.diameter) / 2.0f, -(m_width / 2.0f + m_wheel.width)),
-		Point2f( (m_length - m_wheel.diameter) / 2.0f, -(m_width / 2.0f + m_wheel.width))
-	};
-		
-	for (auto currentWheelCenter : wheelCenter)
+	Outline outline = this->outline();
+	for (size_t index = 0; index < outline.size; index++)
 	{
-		vector<Point2f> currentWheel =
-		{
-			point(currentWheelCenter, -m_wheel.diameter / 2.0f,  m_wheel.width / 2.0f),
-			point(currentWheelCenter, -m_wheel.diameter / 2.0f, -m_wheel.width / 2.0f),
-			point(currentWheelCenter,  m_wheel.diameter / 2.0f, -m_wheel.width / 2.0f),
-			point(currentWheelCenter,  m_wheel.diameter / 2.0f,  m_wheel.width / 2.0f)
-		};
-
-		poligon(image, currentWheel, black);
+		poligon(image, outline.parts[index], black);
 	}
 
 	return 0;
@@ -258,7 +304,7 @@ int32_t Robot::draw(cv::Mat &image)
 
 float Robot::angle() const
 {
-	return m_angle;
+	return m_transform.angle();
 }
 
 float Robot::width() const
@@ -276,53 +322,41 @@ Wheel Robot::wheel() const
 	return m_wheel;
 }
 
+const Transform& Robot::transform() const
+{
+	m_transform.update();
+	return m_transform;
+}
+
 float Robot::calculateDisplacement(Direction direction)
 {
-	auto borderPoint = [this](const float angle)
-	{
-		auto borderPoint = Point2f();
-		if (cosf(angle) >= 0.0 && sinf(angle) >= 0.0)
-		{
-			borderPoint.x = border().right;
-			borderPoint.y = border().top;
-		}
-		if (cosf(angle) <  0.0 && sinf(angle) >= 0.0)
-		{
-			borderPoint.x = border().left;
-			borderPoint.y = border().top;
-		}
-		if (cosf(angle) <  0.0 && sinf(angle) <  0.0)
-		{
-			borderPoint.x = border().left;
-			borderPoint.y = border().bottom;
-		}
-		if (cosf(angle) >= 0.0 && sinf(angle) <  0.0)
-		{
-			borderPoint.x = border().right;
-			borderPoint.y = border().bottom;
-		}
-		return borderPoint;
-	};
+	PROFILE_SCOPE("Robot::calculateDisplacement");
 
 	float distance = m_speed;
-	float angle = m_angle + static_cast<uint32_t>(direction) * M_PI_2;
+	float angle = m_transform.angle() + static_cast<uint32_t>(direction) * M_PI_2;
+	float cosine = cosf(angle);
+	float sine = sinf(angle);
 
-	for (auto& point : m_boundaryPoints)
+	auto borderPoint = Point2f();
+	borderPoint.x = cosine >= 0.0 ? border().right : border().left;
+	borderPoint.y = sine >= 0.0 ? border().top : border().bottom;
+
+	for (auto& point : boundaryPoints())
 	{
 		float realDistance = FLT_MAX;
 
-		if (fabs(cosf(angle)) > ZERO)
+		if (fabs(cosine) > ZERO)
 		{
-			realDistance = (borderPoint(angle).x - point.x) / cosf(angle);
+			realDistance = (borderPoint.x - point.x) / cosine;
 			if (distance > realDistance)
 			{
 				distance = realDistance;
 			}
 		}
 
-		if (fabs(sinf(angle)) > ZERO)
+		if (fabs(sine) > ZERO)
 		{
-			realDistance = (borderPoint(angle).y - point.y) / sinf(angle);
+			realDistance = (borderPoint.y - point.y) / sine;
 			if (distance > realDistance)
 			{
 				distance = realDistance;
@@ -330,81 +364,219 @@ float Robot::calculateDisplacement(Direction direction)
 		}
 	}
 
+	if (m_obstacles != nullptr && distance > 0.0f)
+	{
+		auto heading = Point2f(cosine, sine);
+		distance = m_obstacles->translationLimit(footprint(), heading, distance);
+	}
+
 	return distance;
 }
 
 float Robot::calculateAngularDisplacement(Rotation rotation)
 {
+	PROFILE_SCOPE("Robot::calculateAngularDisplacement");
+
 	float angle = m_angularSpeed;
+	auto origin = m_transform.translation();
 
-	for (auto& point : m_boundaryPoints)
+	if (FastMath::precision() == Precision::FAST)
 	{
-		float radius = hypotf(point.x - m_center.x, point.y - m_center.y);
-
-		auto distance = [this](Quadrant quadrant)
+		const float distances[] =
+		{
+			fabsf(origin.x - border().left),
+			fabsf(origin.y - border().bottom),
+			fabsf(origin.x - border().right),
+			fabsf(origin.y - border().top)
+		};
+		angle = FastMath::rotationLimit(boundaryPoints(), origin, distances, rotation, angle);
+	}
+	else
+	{
+		for (auto& point : boundaryPoints())
 		{
-			switch (quadrant)
+			float radius = hypotf(point.x - origin.x, point.y - origin.y);
+
+			auto distance = [this](Quadrant quadrant)
 			{
-			case Quadrant::QUADRANT_I:
-				return fabs(center().x - border().left);
-			case Quadrant::QUADRANT_II:
-				return fabs(center().y - border().bottom);
-			case Quadrant::QUADRANT_III:
-				return fabs(center().x - border().right);
-			case Quadrant::QUADRANT_IV:
-				return fabs(center().y - border().top);
-			default:
-				return FLT_MAX;
-			}
+				switch (quadrant)
+				{
+				case Quadrant::QUADRANT_I:
+					return fabs(center().x - border().left);
+				case Quadrant::QUADRANT_II:
+					return fabs(center().y - border().bottom);
+				case Quadrant::QUADRANT_III:
+					return fabs(center().x - border().right);
+				case Quadrant::QUADRANT_IV:
+					return fabs(center().y - border().top);
+				default:
+					return FLT_MAX;
+				}
+			};
+
+			auto realAngle = [this, distance, &radius, &angle, &origin](Point2f point, Rotation rotation, Quadrant quadrant)
+			{
+				float realAngle = angle;
+				if (distance(quadrant) < radius)
+				{
+					float alpha = static_cast<int32_t>(quadrant) * M_PI_2;
+					float phi = atan2f((point.y - origin.y) * cosf(alpha) - (point.x - origin.x) * sinf(alpha),
+									   (point.y - origin.y) * sinf(alpha) + (point.x - origin.x) * cosf(alpha));
+					float dPhi = acosf(distance(quadrant) / radius);
+					realAngle = M_PI - dPhi - (static_cast<int32_t>(rotation) * 2 - 1) * phi;
+				}
+				if (angle > realAngle)
+				{
+					return realAngle;
+				}
+				return angle;
+			};
+
+			angle = realAngle(point, rotation, Quadrant::QUADRANT_I  );
+			angle = realAngle(point, rotation, Quadrant::QUADRANT_II );
+			angle = realAngle(point, rotation, Quadrant::QUADRANT_III);
+			angle = realAngle(point, rotation, Quadrant::QUADRANT_IV );
+		}
+	}
+
+	if (m_obstacles != nullptr && angle > 0.0f)
+	{
+		float sign = static_cast<int32_t>(rotation) * 2.0f - 1.0f;
+		angle = m_obstacles->rotationLimit(footprint(), origin, sign, angle);
+	}
+
+	return angle;
+}
+
+float Robot::calculateSweep(Direction direction, Rotation rotation)
+{
+	PROFILE_SCOPE("Robot::calculateSweep");
+
+	auto displacement = heading(direction) * m_speed;
+	float angularDisplacement = (static_cast<int32_t>(rotation) * 2.0f - 1.0f) * m_angularSpeed;
+	auto origin = m_transform.translation();
+
+	float fraction = 1.0f;
+
+	for (auto& point : boundaryPoints())
+	{
+		auto offset = Point2f(point.x - origin.x, point.y - origin.y);
+		float rate = hypotf(displacement.x, displacement.y) + hypotf(offset.x, offset.y) * fabs(angularDisplacement);
+
+		if (rate <= 0.0f)
+		{
+			continue;
+		}
+
+		auto position = [&](const float time)
+		{
+			float cos = cosf(time * angularDisplacement);
+			float sin = sinf(time * angularDisplacement);
+			return Point2f(
+				origin.x + time * displacement.x + offset.x * cos - offset.y * sin,
+				origin.y + time * displacement.y + offset.x * sin + offset.y * cos
+			);
+		};
+
+		auto velocity = [&](const float time)
+		{
+			float cos = cosf(time * angularDisplacement);
+			float sin = sinf(time * angularDisplacement);
+			return Point2f(
+				displacement.x - angularDisplacement * (offset.x * sin + offset.y * cos),
+				displacement.y + angularDisplacement * (offset.x * cos - offset.y * sin)
+			);
 		};
 
-		auto realAngle = [this, distance, &radius, &angle](Point2f point, Rotation rotation, Quadrant quadrant)
+		auto impact = [&](const Point2f normal, const float limit)
 		{
-			float realAngle = angle;
-			if (distance(quadrant) < radius)
+			if (limit - normal.dot(point) > rate * fraction)
 			{
-				float alpha = static_cast<int32_t>(quadrant) * M_PI_2;
-				float phi = atan2f((point.y - m_center.y) * cosf(alpha) - (point.x - m_center.x) * sinf(alpha),
-								   (point.y - m_center.y) * sinf(alpha) + (point.x - m_center.x) * cosf(alpha));
-				float dPhi = acosf(distance(quadrant) / radius);
-				realAngle = M_PI - dPhi - (static_cast<int32_t>(rotation) * 2 - 1) * phi;
+				return fraction;
 			}
-			if (angle > realAngle)
+
+			float time = 0.0f;
+			for (int32_t iteration = 0; iteration < SWEEP_ITERATIONS && time < fraction; iteration++)
 			{
-				return realAngle;
+				float slack = limit - normal.dot(position(time));
+				if (slack > SWEEP_TOLERANCE)
+				{
+					time += slack / rate;
+				}
+				else if (normal.dot(velocity(time)) < 0.0f)
+				{
+					time += SWEEP_STEP;
+				}
+				else
+				{
+					break;
+				}
 			}
-			return angle;
+			return min(time, fraction);
 		};
 
-		angle = realAngle(point, rotation, Quadrant::QUADRANT_I  );
-		angle = realAngle(point, rotation, Quadrant::QUADRANT_II );
-		angle = realAngle(point, rotation, Quadrant::QUADRANT_III);
-		angle = realAngle(point, rotation, Quadrant::QUADRANT_IV );
+		fraction = impact(Point2f( 1.0f,  0.0f),  border().right );
+		fraction = impact(Point2f( 0.0f,  1.0f),  border().top   );
+		fraction = impact(Point2f(-1.0f,  0.0f), -border().left  );
+		fraction = impact(Point2f( 0.0f, -1.0f), -border().bottom);
 	}
 
-	return angle;
+	if (m_obstacles != nullptr && fraction > 0.0f)
+	{
+		fraction = min(fraction, m_obstacles->sweepLimit(footprint(), origin, displacement, angularDisplacement));
+	}
+
+	return fraction;
 }
 
-vector<Point2f> Robot::boundaryPoints()
+PolygonPoints Robot::boundaryPoints()
 {
-	auto point = [this](const float x, const float y)
-	{
-		auto point = cv::Point2f();
-		point.x = m_center.x + x * cosf(m_angle) - y * sinf(m_angle);
-		point.y = m_center.y + x * sinf(m_angle) + y * cosf(m_angle);
+	m_transform.update();
+	return m_footprint.points(m_transform);
+}
 
-		return point;
-	};
+Footprint Robot::footprint()
+{
+	Footprint footprint;
+	m_transform.update();
+	footprint.parts[0] = m_footprint.points(m_transform);
+	footprint.size = 1;
+
+	return footprint;
+}
 
-	vector<Point2f> points =
+Outline Robot::outline()
+{
+	Outline outline;
+	m_transform.update();
+	outline.parts[0] = m_hull.points(m_transform);
+	outline.size = 1;
+
+	for (auto& currentWheel : m_wheels)
 	{
-		point( m_length / 2.0f,  (m_width + 3.0f * m_wheel.width) / 2.0f),
-		point(-m_length / 2.0f,  (m_width + 3.0f * m_wheel.width) / 2.0f),
-		point(-m_length / 2.0f, -(m_width + 3.0f * m_wheel.width) / 2.0f),
-		point( m_length / 2.0f, -(m_width + 3.0f * m_wheel.width) / 2.0f)
-	};
+		outline.parts[outline.size++] = currentWheel.points(m_transform);
+	}
+
+	return outline;
+}
+
+cv::Point2f Robot::heading(Direction direction) const
+{
+	float angle = m_transform.angle();
 
-	return points;
+	switch (direction)
+	{
+	case Direction::FORWARD:
+		return Point2f( cosf(angle),  sinf(angle));
+	case Direction::BACK:
+		return Point2f(-cosf(angle), -sinf(angle));
+	case Direction::LEFT:
+		return Point2f(-sinf(angle),  cosf(angle));
+	case Direction::RIGHT:
+		return Point2f( sinf(angle), -cosf(angle));
+	default:
+		return Point2f();
+	}
 }
 
 void Robot::doSomething(const char key)
@@ -4,10 +4,12 @@
 #include <math.h>
 
 #include "opencv2/core.hpp"
-#include "opencv2/highgui.hpp"
+#include "transform.h"
 
 #define SPEED 5.0
 #define ANGULAR_SPEED 0.1
+#define FOOTPRINT_CAPACITY 4
+#define OUTLINE_CAPACITY 8
 
 enum class Direction
 {
@@ -45,6 +47,20 @@ struct Border
 	float bottom;
 };
 
+struct Footprint
+{
+	PolygonPoints parts[FOOTPRINT_CAPACITY];
+	size_t size;
+};
+
+struct Outline
+{
+	PolygonPoints parts[OUTLINE_CAPACITY];
+	size_t size;
+};
+
+class ObstacleMap;
+
 class Robot
 {
 public:
@@ -73,9 +89,14 @@ public:
 	int32_t setCenter(cv::Mat image);
 	cv::Point2f center() const;
 
+	void setAngle(const float angle);
+
 	void setBorder(const Border border);
 	Border border() const;
 
+	void setObstacles(const ObstacleMap* obstacles);
+	const ObstacleMap* obstacles() const;
+
 	virtual int32_t draw(cv::Mat& image);
 
 	int32_t move(Direction direction);
@@ -90,19 +111,28 @@ public:
 	float length() const;
 	Wheel wheel() const;
 
+	const Transform& transform() const;
+
 	float calculateDisplacement(Direction direction);
 	float calculateAngularDisplacement(Rotation rotation);
-	virtual std::vector<cv::Point2f> boundaryPoints();
+	float calculateSweep(Direction direction, Rotation rotation);
+	virtual PolygonPoints boundaryPoints();
+	virtual Footprint footprint();
+	virtual Outline outline();
 
 private:
-	cv::Point2f m_center;
-	float m_angle;
+	cv::Point2f heading(Direction direction) const;
+
+	Transform m_transform;
 	const float m_width;
 	const float m_length;
 	const Wheel m_wheel;
 	float m_speed;
 	float m_angularSpeed;
 	cv::Size2i m_area;
-	std::vector<cv::Point2f> m_boundaryPoints;
 	Border m_border;
+	const ObstacleMap* m_obstacles;
+	CachedPolygon m_footprint;
+	CachedPolygon m_hull;
+	CachedPolygon m_wheels[4];
 };
@@ -0,0 +1,42 @@
+#include "benchmark.h"
+
+using namespace std;
+using namespace cv;
+
+void benchmarkRobot(Benchmark& benchmark)
+{
+	auto& robots = benchmark.robots();
+	auto& image = benchmark.image();
+
+	benchmark.measure("Robot::calculateDisplacement", robots.size(), [&robots](size_t index)
+	{
+		return robots[index].calculateDisplacement(static_cast<Direction>(index % 4));
+	});
+
+	benchmark.measure("Robot::calculateAngularDisplacement", robots.size(), [&robots](size_t index)
+	{
+		return robots[index].calculateAngularDisplacement(static_cast<Rotation>(index % 2));
+	});
+
+	benchmark.measure("CombatModule::calculateAngularDisplacement", robots.size(), [&robots](size_t index)
+	{
+		return robots[index].combatModule().calculateAngularDisplacement(static_cast<Rotation>(index % 2));
+	});
+
+	benchmark.measure("WarRobot::boundaryPoints", robots.size(), [&robots](size_t index)
+	{
+		return robots[index].boundaryPoints().front().x;
+	});
+
+	benchmark.measure("WarRobot::draw", robots.size(), [&robots, &image](size_t index)
+	{
+		return static_cast<float>(robots[index].draw(image));
+	});
+
+	benchmark.measure("WarRobot::doSomething+draw", robots.size(), [&robots, &image](size_t index)
+	{
+		const char keys[] = "wasdqezx.,[]";
+		robots[index].doSomething(keys[index % (sizeof(keys) - 1)]);
+		return static_cast<float>(robots[index].draw(image));
+	});
+}
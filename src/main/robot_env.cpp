@@ -0,0 +1,106 @@
+#include "robot_env.h"
+#include "vector_env.h"
+
+using namespace std;
+using namespace cv;
+
+struct RobotEnv : public VectorEnv
+{
+	RobotEnv(const RobotEnvConfig& config) :
+		VectorEnv(
+			config.environments,
+			config.robots,
+			Size2i(config.width, config.height),
+			Size2i(config.renderWidth, config.renderHeight),
+			config.threads,
+			config.seed
+		)
+	{
+
+	}
+};
+
+RobotEnv* robot_env_create(const RobotEnvConfig* config)
+{
+	if (config == nullptr || config->environments == 0 || config->robots == 0 ||
+		config->width <= 0 || config->height <= 0 || config->renderWidth < 0 || config->renderHeight < 0)
+	{
+		return nullptr;
+	}
+
+	// Nothing may unwind across the C boundary.
+	try
+	{
+		return new RobotEnv(*config);
+	}
+	catch (...)
+	{
+		return nullptr;
+	}
+}
+
+void robot_env_destroy(RobotEnv* env)
+{
+	delete env;
+}
+
+size_t robot_env_observation_bytes(const RobotEnv* env)
+{
+	return env != nullptr ? env->observationBytes() : 0;
+}
+
+size_t robot_env_render_bytes(const RobotEnv* env)
+{
+	return env != nullptr ? env->renderBytes() : 0;
+}
+
+int32_t robot_env_bind(RobotEnv* env, float* observations, uint8_t* renders)
+{
+	if (env == nullptr)
+	{
+		return -1;
+	}
+
+	try
+	{
+		return env->bind(observations, renders);
+	}
+	catch (...)
+	{
+		return -2;
+	}
+}
+
+int32_t robot_env_reset(RobotEnv* env, const uint8_t* mask)
+{
+	if (env == nullptr)
+	{
+		return -1;
+	}
+
+	try
+	{
+		return env->reset(mask);
+	}
+	catch (...)
+	{
+		return -2;
+	}
+}
+
+int32_t robot_env_step(RobotEnv* env, const uint8_t* actions)
+{
+	if (env == nullptr)
+	{
+		return -1;
+	}
+
+	try
+	{
+		return env->step(actions);
+	}
+	catch (...)
+	{
+		return -2;
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(ROBOT_ENV_EXPORTS)
+#define ROBOT_ENV_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(ROBOT_ENV_IMPORTS)
+#define ROBOT_ENV_API __declspec(dllimport)
+#else
+#define ROBOT_ENV_API
+#endif
+
+// One action byte per robot, the commands WarRobot::doSomething takes as keys.
+#define ROBOT_ENV_ACTION_NONE 0
+#define ROBOT_ENV_ACTION_FORWARD 1
+#define ROBOT_ENV_ACTION_BACK 2
+#define ROBOT_ENV_ACTION_LEFT 3
+#define ROBOT_ENV_ACTION_RIGHT 4
+#define ROBOT_ENV_ACTION_FORWARD_COUNTER_CLOCKWISE 5
+#define ROBOT_ENV_ACTION_FORWARD_CLOCKWISE 6
+#define ROBOT_ENV_ACTION_BACK_CLOCKWISE 7
+#define ROBOT_ENV_ACTION_BACK_COUNTER_CLOCKWISE 8
+#define ROBOT_ENV_ACTION_ROTATE_CLOCKWISE 9
+#define ROBOT_ENV_ACTION_ROTATE_COUNTER_CLOCKWISE 10
+#define ROBOT_ENV_ACTION_TURRET_CLOCKWISE 11
+#define ROBOT_ENV_ACTION_TURRET_COUNTER_CLOCKWISE 12
+#define ROBOT_ENV_ACTION_COUNT 13
+
+// Floats per robot: center x, center y, angle, turret angle and the smallest
+// clearance of the footprint to the right, top, left and bottom of the Border.
+#define ROBOT_ENV_OBSERVATION_SIZE 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct RobotEnv RobotEnv;
+
+typedef struct RobotEnvConfig
+{
+	uint32_t environments;
+	uint32_t robots;
+	int32_t width;
+	int32_t height;
+	int32_t renderWidth;
+	int32_t renderHeight;
+	uint32_t threads;
+	uint32_t seed;
+} RobotEnvConfig;
+
+// Observations are laid out [environment][robot][ROBOT_ENV_OBSERVATION_SIZE]
+// and renders [environment][renderHeight][renderWidth], one byte per pixel.
+// Both buffers belong to the caller and may live in shared memory; they must
+// stay valid until rebound or the environment is destroyed. reset() and
+// step() write straight into them without copying or allocating on the step.
+// The int32_t calls return 0 on success, -1 for a missing environment or
+// buffer and -2 when the simulation failed; no C++ exception crosses this
+// interface. Build the ReleaseDll configuration to get robot_env.dll.
+ROBOT_ENV_API RobotEnv* robot_env_create(const RobotEnvConfig* config);
+ROBOT_ENV_API void robot_env_destroy(RobotEnv* env);
+
+ROBOT_ENV_API size_t robot_env_observation_bytes(const RobotEnv* env);
+ROBOT_ENV_API size_t robot_env_render_bytes(const RobotEnv* env);
+ROBOT_ENV_API int32_t robot_env_bind(RobotEnv* env, float* observations, uint8_t* renders);
+
+ROBOT_ENV_API int32_t robot_env_reset(RobotEnv* env, const uint8_t* mask);
+ROBOT_ENV_API int32_t robot_env_step(RobotEnv* env, const uint8_t* actions);
+
+#ifdef __cplusplus
+}
+#endif
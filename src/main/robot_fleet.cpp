@@ -0,0 +1,435 @@
+#include "robot_fleet.h"
+#include "simd.h"
+
+#define ZERO 0.000001
+
+using namespace std;
+using namespace cv;
+
+RobotFleet::RobotFleet(const Border border) :
+	m_size(0),
+	m_border(border)
+{
+
+}
+
+size_t RobotFleet::add(const Robot& robot)
+{
+	return add(
+		robot.width(),
+		robot.length(),
+		robot.wheel(),
+		robot.center(),
+		robot.angle(),
+		robot.speed(),
+		robot.angularSpeed()
+	);
+}
+
+size_t RobotFleet::add(
+	const float width,
+	const float length,
+	const Wheel wheel,
+	const cv::Point2f center,
+	const float angle,
+	const float speed,
+	const float angularSpeed
+)
+{
+	size_t index = m_size;
+	resize(m_size + 1);
+
+	m_centerX[index] = center.x;
+	m_centerY[index] = center.y;
+	m_angle[index] = angle;
+	m_cos[index] = cosf(angle);
+	m_sin[index] = sinf(angle);
+	m_speed[index] = speed;
+	m_angularSpeed[index] = angularSpeed;
+	m_halfLength[index] = length / 2.0f;
+	m_halfWidth[index] = (width + 3.0f * wheel.width) / 2.0f;
+	m_radius[index] = hypotf(m_halfLength[index], m_halfWidth[index]);
+	m_displacement[index] = 0.0f;
+	m_clearanceRight[index] = fabsf(center.x - m_border.right);
+	m_clearanceTop[index] = fabsf(center.y - m_border.top);
+	m_clearanceLeft[index] = fabsf(center.x - m_border.left);
+	m_clearanceBottom[index] = fabsf(center.y - m_border.bottom);
+
+	return index;
+}
+
+void RobotFleet::clear()
+{
+	resize(0);
+}
+
+size_t RobotFleet::size() const
+{
+	return m_size;
+}
+
+void RobotFleet::setBorder(const Border border)
+{
+	m_border = border;
+	resize(m_size);
+	updateClearance();
+}
+
+Border RobotFleet::border() const
+{
+	return m_border;
+}
+
+int32_t RobotFleet::move(Direction direction)
+{
+	const float* directionX;
+	const float* directionY;
+	float signX;
+	float signY;
+
+	switch (direction)
+	{
+	case Direction::FORWARD:
+		directionX = m_cos.data(); signX =  1.0f;
+		directionY = m_sin.data(); signY =  1.0f;
+		break;
+	case Direction::BACK:
+		directionX = m_cos.data(); signX = -1.0f;
+		directionY = m_sin.data(); signY = -1.0f;
+		break;
+	case Direction::LEFT:
+		directionX = m_sin.data(); signX = -1.0f;
+		directionY = m_cos.data(); signY =  1.0f;
+		break;
+	case Direction::RIGHT:
+		directionX = m_sin.data(); signX =  1.0f;
+		directionY = m_cos.data(); signY = -1.0f;
+		break;
+	default:
+		return -1;
+	}
+
+	const float cornerX[] = { 1.0f, -1.0f, -1.0f,  1.0f };
+	const float cornerY[] = { 1.0f,  1.0f, -1.0f, -1.0f };
+
+	const simd::Lane zero = simd::set(0.0f);
+	const simd::Lane epsilon = simd::set(static_cast<float>(ZERO));
+	const simd::Lane right = simd::set(m_border.right);
+	const simd::Lane top = simd::set(m_border.top);
+	const simd::Lane left = simd::set(m_border.left);
+	const simd::Lane bottom = simd::set(m_border.bottom);
+
+	for (size_t index = 0; index < m_size; index += simd::LANES)
+	{
+		simd::Lane cosine = simd::load(&m_cos[index]);
+		simd::Lane sine = simd::load(&m_sin[index]);
+		simd::Lane dx = simd::mul(simd::set(signX), simd::load(directionX + index));
+		simd::Lane dy = simd::mul(simd::set(signY), simd::load(directionY + index));
+		simd::Lane centerX = simd::load(&m_centerX[index]);
+		simd::Lane centerY = simd::load(&m_centerY[index]);
+		simd::Lane halfLength = simd::load(&m_halfLength[index]);
+		simd::Lane halfWidth = simd::load(&m_halfWidth[index]);
+
+		simd::Lane borderX = simd::select(simd::greaterEqual(dx, zero), right, left);
+		simd::Lane borderY = simd::select(simd::greaterEqual(dy, zero), top, bottom);
+		simd::Mask validX = simd::greater(simd::abs(dx), epsilon);
+		simd::Mask validY = simd::greater(simd::abs(dy), epsilon);
+
+		simd::Lane distance = simd::load(&m_speed[index]);
+
+		for (int32_t corner = 0; corner < 4; corner++)
+		{
+			simd::Lane x = simd::mul(simd::set(cornerX[corner]), halfLength);
+			simd::Lane y = simd::mul(simd::set(cornerY[corner]), halfWidth);
+			simd::Lane pointX = simd::sub(simd::add(centerX, simd::mul(x, cosine)), simd::mul(y, sine));
+			simd::Lane pointY = simd::add(simd::add(centerY, simd::mul(x, sine)), simd::mul(y, cosine));
+
+			simd::Lane realDistanceX = simd::div(simd::sub(borderX, pointX), dx);
+			distance = simd::select(validX, simd::min(realDistanceX, distance), distance);
+
+			simd::Lane realDistanceY = simd::div(simd::sub(borderY, pointY), dy);
+			distance = simd::select(validY, simd::min(realDistanceY, distance), distance);
+		}
+
+		simd::store(&m_displacement[index], distance);
+		simd::store(&m_centerX[index], simd::add(centerX, simd::mul(distance, dx)));
+		simd::store(&m_centerY[index], simd::add(centerY, simd::mul(distance, dy)));
+	}
+
+	updateClearance();
+
+	for (size_t index = 0; index < m_size; index++)
+	{
+		if (m_displacement[index] < m_speed[index])
+		{
+			return -2;
+		}
+	}
+
+	return 0;
+}
+
+int32_t RobotFleet::rotate(Rotation rotation)
+{
+	float sign;
+
+	switch (rotation)
+	{
+	case Rotation::CLOCKWISE:
+		sign = -1.0f;
+		break;
+	case Rotation::COUNTER_CLOCKWISE:
+		sign =  1.0f;
+		break;
+	default:
+		return -1;
+	}
+
+	const simd::Lane scale = simd::set(1.0001f);
+	const simd::Lane margin = simd::set(0.01f);
+	const simd::Lane blocked = simd::set(-1.0f);
+
+	for (size_t index = 0; index < m_size; index += simd::LANES)
+	{
+		simd::Lane clearance = simd::min(
+			simd::min(simd::load(&m_clearanceRight[index]), simd::load(&m_clearanceTop[index])),
+			simd::min(simd::load(&m_clearanceLeft[index]), simd::load(&m_clearanceBottom[index]))
+		);
+		simd::Lane radius = simd::add(simd::mul(simd::load(&m_radius[index]), scale), margin);
+
+		simd::Mask free = simd::greater(clearance, radius);
+		simd::store(&m_displacement[index], simd::select(free, simd::load(&m_angularSpeed[index]), blocked));
+	}
+
+	for (size_t index = 0; index < m_size; index++)
+	{
+		if (m_displacement[index] < 0.0f)
+		{
+			m_displacement[index] = calculateAngularDisplacement(index, rotation);
+		}
+	}
+
+	for (size_t index = 0; index < m_size; index += simd::LANES)
+	{
+		simd::Lane angle = simd::load(&m_angle[index]);
+		simd::Lane displacement = simd::load(&m_displacement[index]);
+		simd::store(&m_angle[index], simd::add(angle, simd::mul(simd::set(sign), displacement)));
+	}
+
+	int32_t result = 0;
+
+	for (size_t index = 0; index < m_size; index++)
+	{
+		m_cos[index] = cosf(m_angle[index]);
+		m_sin[index] = sinf(m_angle[index]);
+
+		if (m_displacement[index] < m_angularSpeed[index])
+		{
+			result = -2;
+		}
+	}
+
+	return result;
+}
+
+cv::Point2f RobotFleet::center(size_t index) const
+{
+	return Point2f(m_centerX.at(index), m_centerY.at(index));
+}
+
+float RobotFleet::angle(size_t index) const
+{
+	return m_angle.at(index);
+}
+
+float RobotFleet::speed(size_t index) const
+{
+	return m_speed.at(index);
+}
+
+float RobotFleet::angularSpeed(size_t index) const
+{
+	return m_angularSpeed.at(index);
+}
+
+Border RobotFleet::clearance(size_t index) const
+{
+	Border clearance =
+	{
+		m_clearanceRight.at(index),
+		m_clearanceTop.at(index),
+		m_clearanceLeft.at(index),
+		m_clearanceBottom.at(index)
+	};
+
+	return clearance;
+}
+
+float RobotFleet::displacement(size_t index) const
+{
+	return m_displacement.at(index);
+}
+
+float RobotFleet::calculateDisplacement(size_t index, Direction direction) const
+{
+	auto borderPoint = [this](const float angle)
+	{
+		auto borderPoint = Point2f();
+		borderPoint.x = cosf(angle) >= 0.0 ? m_border.right : m_border.left;
+		borderPoint.y = sinf(angle) >= 0.0 ? m_border.top : m_border.bottom;
+		return borderPoint;
+	};
+
+	Point2f points[4];
+	boundaryPoints(index, points);
+
+	float distance = m_speed.at(index);
+	float angle = m_angle.at(index) + static_cast<uint32_t>(direction) * M_PI_2;
+
+	for (auto& point : points)
+	{
+		float realDistance = FLT_MAX;
+
+		if (fabs(cosf(angle)) > ZERO)
+		{
+			realDistance = (borderPoint(angle).x - point.x) / cosf(angle);
+			if (distance > realDistance)
+			{
+				distance = realDistance;
+			}
+		}
+
+		if (fabs(sinf(angle)) > ZERO)
+		{
+			realDistance = (borderPoint(angle).y - point.y) / sinf(angle);
+			if (distance > realDistance)
+			{
+				distance = realDistance;
+			}
+		}
+	}
+
+	return distance;
+}
+
+float RobotFleet::calculateAngularDisplacement(size_t index, Rotation rotation) const
+{
+	float angle = m_angularSpeed.at(index);
+
+	const float centerX = m_centerX[index];
+	const float centerY = m_centerY[index];
+	const float distance[] =
+	{
+		m_clearanceLeft[index],
+		m_clearanceBottom[index],
+		m_clearanceRight[index],
+		m_clearanceTop[index]
+	};
+
+	Point2f points[4];
+	boundaryPoints(index, points);
+
+	for (auto& point : points)
+	{
+		float radius = hypotf(point.x - centerX, point.y - centerY);
+
+		for (int32_t quadrant = 0; quadrant < 4; quadrant++)
+		{
+			if (distance[quadrant] < radius)
+			{
+				float alpha = quadrant * M_PI_2;
+				float phi = atan2f((point.y - centerY) * cosf(alpha) - (point.x - centerX) * sinf(alpha),
+				                   (point.y - centerY) * sinf(alpha) + (point.x - centerX) * cosf(alpha));
+				float dPhi = acosf(distance[quadrant] / radius);
+				float realAngle = M_PI - dPhi - (static_cast<int32_t>(rotation) * 2 - 1) * phi;
+				if (angle > realAngle)
+				{
+					angle = realAngle;
+				}
+			}
+		}
+	}
+
+	return angle;
+}
+
+void RobotFleet::boundaryPoints(size_t index, cv::Point2f points[4]) const
+{
+	const float x = m_halfLength.at(index);
+	const float y = m_halfWidth.at(index);
+	const float cosine = m_cos[index];
+	const float sine = m_sin[index];
+
+	auto point = [this, index, cosine, sine](const float x, const float y)
+	{
+		auto point = cv::Point2f();
+		point.x = m_centerX[index] + x * cosine - y * sine;
+		point.y = m_centerY[index] + x * sine + y * cosine;
+
+		return point;
+	};
+
+	points[0] = point( x,  y);
+	points[1] = point(-x,  y);
+	points[2] = point(-x, -y);
+	points[3] = point( x, -y);
+}
+
+const char* RobotFleet::instructionSet()
+{
+#if defined(SIMD_AVX2)
+	return "AVX2";
+#elif defined(SIMD_SSE2)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+void RobotFleet::resize(size_t size)
+{
+	size_t capacity = (size + simd::LANES - 1) / simd::LANES * simd::LANES;
+
+	for (auto array : {
+		&m_centerX, &m_centerY, &m_angle, &m_cos, &m_sin, &m_speed, &m_angularSpeed,
+		&m_halfLength, &m_halfWidth, &m_radius, &m_clearanceRight, &m_clearanceTop,
+		&m_clearanceLeft, &m_clearanceBottom, &m_displacement })
+	{
+		array->resize(capacity, 0.0f);
+	}
+
+	for (size_t index = size; index < capacity; index++)
+	{
+		m_centerX[index] = (m_border.left + m_border.right) / 2.0f;
+		m_centerY[index] = (m_border.bottom + m_border.top) / 2.0f;
+		m_angle[index] = 0.0f;
+		m_cos[index] = 1.0f;
+		m_sin[index] = 0.0f;
+		m_speed[index] = 0.0f;
+		m_angularSpeed[index] = 0.0f;
+		m_halfLength[index] = 0.0f;
+		m_halfWidth[index] = 0.0f;
+		m_radius[index] = 0.0f;
+	}
+
+	m_size = size;
+}
+
+void RobotFleet::updateClearance()
+{
+	const simd::Lane right = simd::set(m_border.right);
+	const simd::Lane top = simd::set(m_border.top);
+	const simd::Lane left = simd::set(m_border.left);
+	const simd::Lane bottom = simd::set(m_border.bottom);
+
+	for (size_t index = 0; index < m_size; index += simd::LANES)
+	{
+		simd::Lane centerX = simd::load(&m_centerX[index]);
+		simd::Lane centerY = simd::load(&m_centerY[index]);
+
+		simd::store(&m_clearanceRight[index], simd::abs(simd::sub(centerX, right)));
+		simd::store(&m_clearanceTop[index], simd::abs(simd::sub(centerY, top)));
+		simd::store(&m_clearanceLeft[index], simd::abs(simd::sub(centerX, left)));
+		simd::store(&m_clearanceBottom[index], simd::abs(simd::sub(centerY, bottom)));
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "robot.h"
+
+// Structure-of-arrays storage for many chassis sharing one arena Border.
+// Poses are stepped for the whole fleet at once with SSE/AVX2 kernels when
+// the compiler targets them and a scalar loop otherwise.
+//
+// Rotation limits are bit-identical to Robot::calculateAngularDisplacement.
+// Translation limits use the cached heading cos/sin rotated by quarter turns
+// instead of cosf(angle + k * M_PI_2), so they agree with
+// Robot::calculateDisplacement to float rounding (below 1e-3 px per step).
+class RobotFleet
+{
+public:
+	RobotFleet(const Border border = { 1079.0f, 719.0f, 0.0f, 0.0f });
+	~RobotFleet() = default;
+
+	size_t add(const Robot& robot);
+	size_t add(
+		const float width,
+		const float length,
+		const Wheel wheel,
+		const cv::Point2f center,
+		const float angle,
+		const float speed = SPEED,
+		const float angularSpeed = ANGULAR_SPEED
+	);
+	void clear();
+	size_t size() const;
+
+	void setBorder(const Border border);
+	Border border() const;
+
+	int32_t move(Direction direction);
+	int32_t rotate(Rotation rotation);
+
+	cv::Point2f center(size_t index) const;
+	float angle(size_t index) const;
+	float speed(size_t index) const;
+	float angularSpeed(size_t index) const;
+	Border clearance(size_t index) const;
+	float displacement(size_t index) const;
+
+	float calculateDisplacement(size_t index, Direction direction) const;
+	float calculateAngularDisplacement(size_t index, Rotation rotation) const;
+	void boundaryPoints(size_t index, cv::Point2f points[4]) const;
+
+	static const char* instructionSet();
+
+private:
+	void resize(size_t size);
+	void updateClearance();
+
+	size_t m_size;
+	Border m_border;
+
+	std::vector<float> m_centerX;
+	std::vector<float> m_centerY;
+	std::vector<float> m_angle;
+	std::vector<float> m_cos;
+	std::vector<float> m_sin;
+	std::vector<float> m_speed;
+	std::vector<float> m_angularSpeed;
+	std::vector<float> m_halfLength;
+	std::vector<float> m_halfWidth;
+	std::vector<float> m_radius;
+	std::vector<float> m_clearanceRight;
+	std::vector<float> m_clearanceTop;
+	std::vector<float> m_clearanceLeft;
+	std::vector<float> m_clearanceBottom;
+	std::vector<float> m_displacement;
+};
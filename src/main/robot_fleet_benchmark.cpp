@@ -0,0 +1,22 @@
+#include "benchmark.h"
+#include "robot_fleet.h"
+
+using namespace std;
+using namespace cv;
+
+void benchmarkRobotFleet(Benchmark& benchmark)
+{
+	auto& robots = benchmark.robots();
+
+	RobotFleet fleet(robots.front().border());
+	for (auto& robot : robots)
+	{
+		fleet.add(robot);
+	}
+
+	benchmark.measure(string("RobotFleet::move/") + RobotFleet::instructionSet(), 2, [&fleet](size_t index)
+	{
+		fleet.move(index % 2 == 0 ? Direction::FORWARD : Direction::BACK);
+		return fleet.displacement(0);
+	}, fleet.size());
+}
@@ -0,0 +1,252 @@
+#pragma once
+
+#include "robot.h"
+#include "war_robot.h"
+
+struct Vertex
+{
+	float x;
+	float y;
+};
+
+template <size_t Count>
+struct ShapeTable
+{
+	Vertex vertices[Count];
+
+	static constexpr size_t size() { return Count; }
+};
+
+// Local-space vertex tables computed at compile time. The vertex order of
+// every table matches the runtime tables built in the Robot and CombatModule
+// constructors, so both paths produce the same polygons.
+namespace geometry
+{
+	constexpr ShapeTable<4> rectangle(const float centerX, const float centerY, const float halfX, const float halfY)
+	{
+		return
+		{{
+			{ centerX + halfX, centerY + halfY },
+			{ centerX - halfX, centerY + halfY },
+			{ centerX - halfX, centerY - halfY },
+			{ centerX + halfX, centerY - halfY }
+		}};
+	}
+
+	constexpr ShapeTable<4> wheel(const float width, const float length, const Wheel wheel, const size_t index)
+	{
+		const float signX = index == 0 || index == 3 ? 1.0f : -1.0f;
+		const float signY = index < 2 ? 1.0f : -1.0f;
+		const float centerX = signX * (length - wheel.diameter) / 2.0f;
+		const float centerY = signY * (width / 2.0f + wheel.width);
+
+		return
+		{{
+			{ centerX - wheel.diameter / 2.0f, centerY + wheel.width / 2.0f },
+			{ centerX - wheel.diameter / 2.0f, centerY - wheel.width / 2.0f },
+			{ centerX + wheel.diameter / 2.0f, centerY - wheel.width / 2.0f },
+			{ centerX + wheel.diameter / 2.0f, centerY + wheel.width / 2.0f }
+		}};
+	}
+
+	constexpr ShapeTable<6> tower(const float width, const float length)
+	{
+		return
+		{{
+			{  length / 2.0f,  width / 4.0f },
+			{  0.0f,           width / 2.0f },
+			{ -length / 2.0f,  width / 4.0f },
+			{ -length / 2.0f, -width / 4.0f },
+			{  0.0f,          -width / 2.0f },
+			{  length / 2.0f, -width / 4.0f }
+		}};
+	}
+
+	// Places a table with the cached world pose of the transform. The trip
+	// count is a compile-time constant, so the loop is fully unrolled; the
+	// result agrees with Transform::apply to float rounding.
+	template <size_t Count>
+	void place(const ShapeTable<Count>& table, const Transform& transform, PolygonPoints& points)
+	{
+		const float cos = transform.cos();
+		const float sin = transform.sin();
+		const cv::Point2f origin = transform.origin();
+
+		points.resize(Count);
+		cv::Point2f* output = points.data();
+
+		for (size_t index = 0; index < Count; index++)
+		{
+			output[index].x = origin.x + table.vertices[index].x * cos - table.vertices[index].y * sin;
+			output[index].y = origin.y + table.vertices[index].x * sin + table.vertices[index].y * cos;
+		}
+	}
+}
+
+// CachedPolygon counterpart for a compile-time table: world points are only
+// recomputed when the transform version changes.
+template <size_t Count>
+class StaticPolygon
+{
+public:
+	StaticPolygon(const ShapeTable<Count>& local) :
+		m_local(&local),
+		m_version(0)
+	{
+
+	}
+
+	const PolygonPoints& points(const Transform& transform) const
+	{
+		if (m_version == transform.version() && m_version != 0)
+		{
+			return m_points;
+		}
+
+		geometry::place(*m_local, transform, m_points);
+		m_version = transform.version();
+
+		return m_points;
+	}
+
+private:
+	const ShapeTable<Count>* m_local;
+	mutable PolygonPoints m_points;
+	mutable uint64_t m_version;
+};
+
+// Compile-time geometry of a fixed robot model. A model is a type with
+// constexpr width, length, wheelWidth, wheelDiameter, turretWidth and
+// turretLength members.
+template <typename Model>
+struct ModelGeometry
+{
+	static constexpr Wheel wheel = { Model::wheelWidth, Model::wheelDiameter };
+
+	static constexpr ShapeTable<4> footprint = geometry::rectangle(
+		0.0f, 0.0f, Model::length / 2.0f, (Model::width + 3.0f * Model::wheelWidth) / 2.0f);
+	static constexpr ShapeTable<4> hull = geometry::rectangle(
+		0.0f, 0.0f, Model::length / 2.0f, Model::width / 2.0f);
+	static constexpr ShapeTable<4> wheels[4] =
+	{
+		geometry::wheel(Model::width, Model::length, wheel, 0),
+		geometry::wheel(Model::width, Model::length, wheel, 1),
+		geometry::wheel(Model::width, Model::length, wheel, 2),
+		geometry::wheel(Model::width, Model::length, wheel, 3)
+	};
+	static constexpr ShapeTable<6> tower = geometry::tower(Model::turretWidth, Model::turretLength);
+	static constexpr ShapeTable<4> gun = geometry::rectangle(
+		0.0f, 0.0f, Model::turretLength / 2.0f, Model::turretWidth / 12.0f);
+};
+
+template <typename Model> constexpr Wheel ModelGeometry<Model>::wheel;
+template <typename Model> constexpr ShapeTable<4> ModelGeometry<Model>::footprint;
+template <typename Model> constexpr ShapeTable<4> ModelGeometry<Model>::hull;
+template <typename Model> constexpr ShapeTable<4> ModelGeometry<Model>::wheels[4];
+template <typename Model> constexpr ShapeTable<6> ModelGeometry<Model>::tower;
+template <typename Model> constexpr ShapeTable<4> ModelGeometry<Model>::gun;
+
+// The fleet model used by the application.
+struct StandardModel
+{
+	static constexpr float width = 60.0f;
+	static constexpr float length = 120.0f;
+	static constexpr float wheelWidth = 10.0f;
+	static constexpr float wheelDiameter = 40.0f;
+	static constexpr float turretWidth = 40.0f;
+	static constexpr float turretLength = 60.0f;
+};
+
+// WarRobot whose boundary, footprint and outline come from the compile-time
+// tables of Model instead of the runtime-sized CachedPolygon tables. The
+// runtime tables are still built by the base class, so every other WarRobot
+// code path behaves as before.
+template <typename Model>
+class ModelRobot : public WarRobot
+{
+public:
+	ModelRobot(
+		const cv::Point2f center = cv::Point2f(0, 0),
+		const float angle = M_PI_2,
+		const float speed = SPEED,
+		const float angularSpeed = ANGULAR_SPEED
+	) :
+		WarRobot(
+			Model::width,
+			Model::length,
+			ModelGeometry<Model>::wheel,
+			CombatModule(Model::turretWidth, Model::turretLength),
+			center,
+			angle,
+			speed,
+			angularSpeed
+		),
+		m_footprint(ModelGeometry<Model>::footprint),
+		m_hull(ModelGeometry<Model>::hull),
+		m_wheels
+		{
+			ModelGeometry<Model>::wheels[0],
+			ModelGeometry<Model>::wheels[1],
+			ModelGeometry<Model>::wheels[2],
+			ModelGeometry<Model>::wheels[3]
+		},
+		m_tower(ModelGeometry<Model>::tower),
+		m_gun(ModelGeometry<Model>::gun)
+	{
+
+	}
+
+	PolygonPoints boundaryPoints()
+	{
+		transform().update();
+		PolygonPoints points = m_footprint.points(transform());
+
+		updateTransforms();
+		auto& gunPoints = m_gun.points(gunTransform());
+		points.append(gunPoints.begin(), gunPoints.end());
+
+		return points;
+	}
+
+	Footprint footprint()
+	{
+		Footprint footprint;
+
+		transform().update();
+		footprint.parts[0] = m_footprint.points(transform());
+
+		updateTransforms();
+		footprint.parts[1] = m_tower.points(turretTransform());
+		footprint.parts[2] = m_gun.points(gunTransform());
+		footprint.size = 3;
+
+		return footprint;
+	}
+
+	Outline outline()
+	{
+		Outline outline;
+
+		transform().update();
+		outline.parts[0] = m_hull.points(transform());
+		outline.size = 1;
+
+		for (auto& currentWheel : m_wheels)
+		{
+			outline.parts[outline.size++] = currentWheel.points(transform());
+		}
+
+		updateTransforms();
+		outline.parts[outline.size++] = m_tower.points(turretTransform());
+		outline.parts[outline.size++] = m_gun.points(gunTransform());
+
+		return outline;
+	}
+
+private:
+	StaticPolygon<4> m_footprint;
+	StaticPolygon<4> m_hull;
+	StaticPolygon<4> m_wheels[4];
+	StaticPolygon<6> m_tower;
+	StaticPolygon<4> m_gun;
+};
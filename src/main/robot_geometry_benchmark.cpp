@@ -0,0 +1,20 @@
+#include "benchmark.h"
+#include "robot_geometry.h"
+
+using namespace std;
+using namespace cv;
+
+void benchmarkRobotGeometry(Benchmark& benchmark)
+{
+	vector<ModelRobot<StandardModel>> models;
+	for (auto& robot : benchmark.robots())
+	{
+		models.push_back(ModelRobot<StandardModel>(robot.center(), robot.angle(), robot.speed(), robot.angularSpeed()));
+		models.back().combatModule().setAngle(robot.combatModule().angle());
+	}
+
+	benchmark.measure("ModelRobot<StandardModel>::boundaryPoints", models.size(), [&models](size_t index)
+	{
+		return models[index].boundaryPoints().front().x;
+	});
+}
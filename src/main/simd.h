@@ -0,0 +1,136 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_SSE2
+#endif
+
+#define SIMD_ATAN2_ERROR 1e-5f
+#define SIMD_ACOS_ERROR 5e-7f
+
+// Float lanes shared by the structure-of-arrays kernels. LANES is 8 with
+// AVX2, 4 with SSE2 and 1 for the scalar fallback; bits() packs one mask bit
+// per lane.
+namespace simd
+{
+#if defined(SIMD_AVX2)
+	typedef __m256 Lane;
+	typedef __m256 Mask;
+	const size_t LANES = 8;
+
+	inline Lane load(const float* pointer) { return _mm256_loadu_ps(pointer); }
+	inline void store(float* pointer, const Lane a) { _mm256_storeu_ps(pointer, a); }
+	inline Lane set(const float a) { return _mm256_set1_ps(a); }
+	inline Lane add(const Lane a, const Lane b) { return _mm256_add_ps(a, b); }
+	inline Lane sub(const Lane a, const Lane b) { return _mm256_sub_ps(a, b); }
+	inline Lane mul(const Lane a, const Lane b) { return _mm256_mul_ps(a, b); }
+	inline Lane div(const Lane a, const Lane b) { return _mm256_div_ps(a, b); }
+	inline Lane min(const Lane a, const Lane b) { return _mm256_min_ps(a, b); }
+	inline Lane abs(const Lane a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+	inline Mask greater(const Lane a, const Lane b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	inline Mask greaterEqual(const Lane a, const Lane b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	inline Lane max(const Lane a, const Lane b) { return _mm256_max_ps(a, b); }
+	inline Mask lessEqual(const Lane a, const Lane b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+	inline Mask both(const Mask a, const Mask b) { return _mm256_and_ps(a, b); }
+	inline int32_t bits(const Mask mask) { return _mm256_movemask_ps(mask); }
+	inline Lane sqrt(const Lane a) { return _mm256_sqrt_ps(a); }
+	inline Lane nearest(const Lane a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+	inline Lane select(const Mask mask, const Lane a, const Lane b) { return _mm256_blendv_ps(b, a, mask); }
+#elif defined(SIMD_SSE2)
+	typedef __m128 Lane;
+	typedef __m128 Mask;
+	const size_t LANES = 4;
+
+	inline Lane load(const float* pointer) { return _mm_loadu_ps(pointer); }
+	inline void store(float* pointer, const Lane a) { _mm_storeu_ps(pointer, a); }
+	inline Lane set(const float a) { return _mm_set1_ps(a); }
+	inline Lane add(const Lane a, const Lane b) { return _mm_add_ps(a, b); }
+	inline Lane sub(const Lane a, const Lane b) { return _mm_sub_ps(a, b); }
+	inline Lane mul(const Lane a, const Lane b) { return _mm_mul_ps(a, b); }
+	inline Lane div(const Lane a, const Lane b) { return _mm_div_ps(a, b); }
+	inline Lane min(const Lane a, const Lane b) { return _mm_min_ps(a, b); }
+	inline Lane abs(const Lane a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+	inline Mask greater(const Lane a, const Lane b) { return _mm_cmpgt_ps(a, b); }
+	inline Mask greaterEqual(const Lane a, const Lane b) { return _mm_cmpge_ps(a, b); }
+	inline Lane max(const Lane a, const Lane b) { return _mm_max_ps(a, b); }
+	inline Mask lessEqual(const Lane a, const Lane b) { return _mm_cmple_ps(a, b); }
+	inline Mask both(const Mask a, const Mask b) { return _mm_and_ps(a, b); }
+	inline int32_t bits(const Mask mask) { return _mm_movemask_ps(mask); }
+	inline Lane sqrt(const Lane a) { return _mm_sqrt_ps(a); }
+	inline Lane nearest(const Lane a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+	inline Lane select(const Mask mask, const Lane a, const Lane b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+#else
+	typedef float Lane;
+	typedef bool Mask;
+	const size_t LANES = 1;
+
+	inline Lane load(const float* pointer) { return *pointer; }
+	inline void store(float* pointer, const Lane a) { *pointer = a; }
+	inline Lane set(const float a) { return a; }
+	inline Lane add(const Lane a, const Lane b) { return a + b; }
+	inline Lane sub(const Lane a, const Lane b) { return a - b; }
+	inline Lane mul(const Lane a, const Lane b) { return a * b; }
+	inline Lane div(const Lane a, const Lane b) { return a / b; }
+	inline Lane min(const Lane a, const Lane b) { return a < b ? a : b; }
+	inline Lane abs(const Lane a) { return fabsf(a); }
+	inline Mask greater(const Lane a, const Lane b) { return a > b; }
+	inline Mask greaterEqual(const Lane a, const Lane b) { return a >= b; }
+	inline Lane max(const Lane a, const Lane b) { return a > b ? a : b; }
+	inline Mask lessEqual(const Lane a, const Lane b) { return a <= b; }
+	inline Mask both(const Mask a, const Mask b) { return a && b; }
+	inline int32_t bits(const Mask mask) { return mask ? 1 : 0; }
+	inline Lane sqrt(const Lane a) { return sqrtf(a); }
+	inline Lane nearest(const Lane a) { return nearbyintf(a); }
+	inline Lane select(const Mask mask, const Lane a, const Lane b) { return mask ? a : b; }
+#endif
+
+	// Polynomial arctangent on the first octant folded out to all four
+	// quadrants; the absolute error is below SIMD_ATAN2_ERROR rad.
+	inline Lane atan2(const Lane y, const Lane x)
+	{
+		const Lane zero = set(0.0f);
+		Lane absoluteX = abs(x);
+		Lane absoluteY = abs(y);
+		Lane ratio = div(min(absoluteX, absoluteY), max(max(absoluteX, absoluteY), set(1e-30f)));
+		Lane square = mul(ratio, ratio);
+
+		Lane result = set(-0.0117212f);
+		result = add(mul(result, square), set(0.05265332f));
+		result = add(mul(result, square), set(-0.11643287f));
+		result = add(mul(result, square), set(0.19354346f));
+		result = add(mul(result, square), set(-0.33262347f));
+		result = add(mul(result, square), set(0.99997726f));
+		result = mul(result, ratio);
+
+		result = select(greater(absoluteY, absoluteX), sub(set(1.57079637f), result), result);
+		result = select(greater(zero, x), sub(set(3.14159274f), result), result);
+		return select(greater(zero, y), sub(zero, result), result);
+	}
+	// Arccosine from the arcsine polynomial, on sqrt((1 - |x|) / 2) above 0.5;
+	// the absolute error is below SIMD_ACOS_ERROR rad for x in [-1, 1].
+	inline Lane acos(const Lane x)
+	{
+		const Lane half = set(0.5f);
+		Lane absolute = min(abs(x), set(1.0f));
+		Mask large = greater(absolute, half);
+		Lane square = select(large, mul(half, sub(set(1.0f), absolute)), mul(absolute, absolute));
+		Lane root = select(large, sqrt(square), absolute);
+
+		Lane result = set(4.2163199048e-2f);
+		result = add(mul(result, square), set(2.4181311049e-2f));
+		result = add(mul(result, square), set(4.5470025998e-2f));
+		result = add(mul(result, square), set(7.4953002686e-2f));
+		result = add(mul(result, square), set(1.6666752422e-1f));
+		result = add(mul(mul(result, square), root), root);
+
+		result = select(large, add(result, result), sub(set(1.57079637f), result));
+		return select(greater(set(0.0f), x), sub(set(3.14159274f), result), result);
+	}
+}
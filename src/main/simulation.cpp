@@ -0,0 +1,149 @@
+#include "simulation.h"
+#include "profiler.h"
+
+#include <chrono>
+
+using namespace std;
+using namespace cv;
+
+Simulation::Simulation(WarRobot& robot, const double timestep) :
+	m_robot(robot),
+	m_timestep(timestep),
+	m_commandLog(nullptr),
+	m_running(false),
+	m_ticks(0),
+	m_droppedCommands(0)
+{
+	publish();
+	update();
+}
+
+Simulation::~Simulation()
+{
+	stop();
+}
+
+void Simulation::setCommandLog(CommandLogWriter* commandLog)
+{
+	m_commandLog = commandLog;
+}
+
+int32_t Simulation::start()
+{
+	if (m_running.load() == true)
+	{
+		return 0;
+	}
+
+	if (m_timestep <= 0.0)
+	{
+		return -1;
+	}
+
+	m_running.store(true);
+	m_thread = thread(&Simulation::run, this);
+
+	return 0;
+}
+
+void Simulation::stop()
+{
+	if (m_running.exchange(false) == false)
+	{
+		return;
+	}
+
+	m_thread.join();
+}
+
+bool Simulation::running() const
+{
+	return m_running.load();
+}
+
+int32_t Simulation::post(const char key)
+{
+	if (m_commands.push(key) != 0)
+	{
+		m_droppedCommands++;
+		return -2;
+	}
+
+	return 0;
+}
+
+bool Simulation::update()
+{
+	return m_snapshots.update();
+}
+
+const WorldSnapshot& Simulation::snapshot() const
+{
+	return m_snapshots.front();
+}
+
+uint64_t Simulation::ticks() const
+{
+	return m_ticks.load();
+}
+
+uint64_t Simulation::droppedCommands() const
+{
+	return m_droppedCommands.load();
+}
+
+void Simulation::apply(const WorldSnapshot& snapshot, WarRobot& view)
+{
+	view.setCenter(snapshot.center.x, snapshot.center.y);
+	view.setAngle(snapshot.angle);
+	view.combatModule().setAngle(snapshot.turretAngle);
+}
+
+void Simulation::run()
+{
+	auto period = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(m_timestep));
+	auto next = chrono::steady_clock::now() + period;
+
+	while (m_running.load() == true)
+	{
+		{
+			PROFILE_SCOPE("Simulation::tick");
+
+			char key;
+			while (m_commands.pop(key) == 0)
+			{
+				if (m_commandLog != nullptr)
+				{
+					m_commandLog->append(m_ticks.load(), key);
+				}
+
+				PROFILE_SCOPE("Robot::doSomething");
+				m_robot.doSomething(key);
+			}
+
+			m_ticks++;
+			publish();
+		}
+
+		this_thread::sleep_until(next);
+		next += period;
+
+		auto now = chrono::steady_clock::now();
+		if (now > next)
+		{
+			next = now + period;
+		}
+	}
+}
+
+void Simulation::publish()
+{
+	auto& snapshot = m_snapshots.back();
+	snapshot.tick = m_ticks.load();
+	snapshot.time = snapshot.tick * m_timestep;
+	snapshot.center = m_robot.center();
+	snapshot.angle = m_robot.angle();
+	snapshot.turretAngle = m_robot.combatModule().angle();
+
+	m_snapshots.publish();
+}
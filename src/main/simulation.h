@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include "war_robot.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+#include "command_log.h"
+
+#define COMMAND_CAPACITY 256
+
+struct WorldSnapshot
+{
+	uint64_t tick;
+	double time;
+	cv::Point2f center;
+	float angle;
+	float turretAngle;
+};
+
+// Steps the robot on its own thread at a fixed rate. Keys are posted from the
+// input thread through a lock-free queue and every tick publishes a snapshot
+// that the display thread applies to its own copy of the robot.
+class Simulation
+{
+public:
+	Simulation(WarRobot& robot, const double timestep = 0.1);
+	~Simulation();
+
+	Simulation(const Simulation&) = delete;
+	Simulation& operator=(const Simulation&) = delete;
+
+	void setCommandLog(CommandLogWriter* commandLog);
+
+	int32_t start();
+	void stop();
+	bool running() const;
+
+	int32_t post(const char key);
+	bool update();
+	const WorldSnapshot& snapshot() const;
+
+	uint64_t ticks() const;
+	uint64_t droppedCommands() const;
+
+	static void apply(const WorldSnapshot& snapshot, WarRobot& view);
+
+private:
+	void run();
+	void publish();
+
+	WarRobot& m_robot;
+	double m_timestep;
+	SpscQueue<char, COMMAND_CAPACITY> m_commands;
+	TripleBuffer<WorldSnapshot> m_snapshots;
+	CommandLogWriter* m_commandLog;
+	std::thread m_thread;
+	std::atomic<bool> m_running;
+	std::atomic<uint64_t> m_ticks;
+	std::atomic<uint64_t> m_droppedCommands;
+};
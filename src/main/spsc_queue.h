@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	SpscQueue() :
+		m_head(0),
+		m_tail(0)
+	{
+
+	}
+
+	int32_t push(const T& value)
+	{
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+		{
+			return -1;
+		}
+
+		m_items[tail & (Capacity - 1)] = value;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return 0;
+	}
+
+	int32_t pop(T& value)
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+		{
+			return -1;
+		}
+
+		value = m_items[head & (Capacity - 1)];
+		m_head.store(head + 1, std::memory_order_release);
+		return 0;
+	}
+
+	size_t size() const { return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire); }
+	bool empty() const { return size() == 0; }
+	static size_t capacity() { return Capacity; }
+
+private:
+	alignas(64) std::atomic<size_t> m_head;
+	alignas(64) std::atomic<size_t> m_tail;
+	T m_items[Capacity];
+};
@@ -0,0 +1,176 @@
+#include "transform.h"
+
+#include <atomic>
+#include <math.h>
+
+using namespace std;
+using namespace cv;
+
+namespace
+{
+	atomic<uint64_t> versionCounter(1);
+
+	uint64_t nextVersion()
+	{
+		return versionCounter.fetch_add(1, memory_order_relaxed);
+	}
+}
+
+Transform::Transform(const cv::Point2f translation, const float angle) :
+	m_translation(translation),
+	m_angle(angle),
+	m_localVersion(nextVersion()),
+	m_parent(nullptr),
+	m_version(0),
+	m_cachedLocalVersion(0),
+	m_cachedParentVersion(0),
+	m_localCos(1.0f),
+	m_localSin(0.0f),
+	m_cos(1.0f),
+	m_sin(0.0f),
+	m_origin(translation)
+{
+
+}
+
+void Transform::setTranslation(const cv::Point2f translation)
+{
+	if (translation.x == m_translation.x && translation.y == m_translation.y)
+	{
+		return;
+	}
+
+	m_translation = translation;
+	m_localVersion = nextVersion();
+}
+
+cv::Point2f Transform::translation() const
+{
+	return m_translation;
+}
+
+void Transform::setAngle(const float angle)
+{
+	if (angle == m_angle)
+	{
+		return;
+	}
+
+	m_angle = angle;
+	m_localVersion = nextVersion();
+}
+
+float Transform::angle() const
+{
+	return m_angle;
+}
+
+bool Transform::update(const Transform* parent) const
+{
+	uint64_t parentVersion = 0;
+	if (parent != nullptr)
+	{
+		parentVersion = parent->version();
+	}
+	m_parent = parent;
+
+	if (m_version != 0 && m_cachedLocalVersion == m_localVersion && m_cachedParentVersion == parentVersion)
+	{
+		return false;
+	}
+
+	if (m_cachedLocalVersion != m_localVersion)
+	{
+		m_localCos = cosf(m_angle);
+		m_localSin = sinf(m_angle);
+	}
+
+	if (parent == nullptr)
+	{
+		m_cos = m_localCos;
+		m_sin = m_localSin;
+		m_origin = m_translation;
+	}
+	else
+	{
+		m_cos = parent->cos() * m_localCos - parent->sin() * m_localSin;
+		m_sin = parent->sin() * m_localCos + parent->cos() * m_localSin;
+		m_origin = parent->apply(m_translation);
+	}
+
+	m_cachedLocalVersion = m_localVersion;
+	m_cachedParentVersion = parentVersion;
+	m_version = nextVersion();
+
+	return true;
+}
+
+uint64_t Transform::version() const
+{
+	return m_version;
+}
+
+float Transform::cos() const
+{
+	return m_cos;
+}
+
+float Transform::sin() const
+{
+	return m_sin;
+}
+
+cv::Point2f Transform::origin() const
+{
+	return m_origin;
+}
+
+cv::Point2f Transform::apply(const cv::Point2f point) const
+{
+	auto result = cv::Point2f();
+	result.x = m_translation.x + point.x * m_localCos - point.y * m_localSin;
+	result.y = m_translation.y + point.x * m_localSin + point.y * m_localCos;
+
+	if (m_parent != nullptr)
+	{
+		return m_parent->apply(result);
+	}
+
+	return result;
+}
+
+CachedPolygon::CachedPolygon(const PolygonPoints local) :
+	m_local(local),
+	m_points(local),
+	m_version(0)
+{
+
+}
+
+void CachedPolygon::setLocal(const PolygonPoints local)
+{
+	m_local = local;
+	m_points = local;
+	m_version = 0;
+}
+
+const PolygonPoints& CachedPolygon::local() const
+{
+	return m_local;
+}
+
+const PolygonPoints& CachedPolygon::points(const Transform& transform) const
+{
+	if (m_version == transform.version() && m_version != 0)
+	{
+		return m_points;
+	}
+
+	for (size_t index = 0; index < m_local.size(); index++)
+	{
+		m_points[index] = transform.apply(m_local[index]);
+	}
+	m_version = transform.version();
+
+	return m_points;
+}
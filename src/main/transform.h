@@ -0,0 +1,63 @@
+#pragma once
+
+#include "opencv2/core.hpp"
+#include "inline_points.h"
+
+// A node of the chassis -> combat module -> gun hierarchy. The local pose is
+// relative to the parent passed to update(), which must be updated first;
+// world rotation and origin are cached and only recomputed when the local
+// pose or the parent changed. apply() maps a point through the cached local
+// matrices of the node and its ancestors in turn.
+class Transform
+{
+public:
+	Transform(const cv::Point2f translation = cv::Point2f(0, 0), const float angle = 0.0f);
+	~Transform() = default;
+
+	void setTranslation(const cv::Point2f translation);
+	cv::Point2f translation() const;
+
+	void setAngle(const float angle);
+	float angle() const;
+
+	bool update(const Transform* parent = nullptr) const;
+	uint64_t version() const;
+
+	float cos() const;
+	float sin() const;
+	cv::Point2f origin() const;
+
+	cv::Point2f apply(const cv::Point2f point) const;
+
+private:
+	cv::Point2f m_translation;
+	float m_angle;
+	uint64_t m_localVersion;
+
+	mutable const Transform* m_parent;
+	mutable uint64_t m_version;
+	mutable uint64_t m_cachedLocalVersion;
+	mutable uint64_t m_cachedParentVersion;
+	mutable float m_localCos;
+	mutable float m_localSin;
+	mutable float m_cos;
+	mutable float m_sin;
+	mutable cv::Point2f m_origin;
+};
+
+class CachedPolygon
+{
+public:
+	CachedPolygon(const PolygonPoints local = PolygonPoints());
+	~CachedPolygon() = default;
+
+	void setLocal(const PolygonPoints local);
+	const PolygonPoints& local() const;
+
+	const PolygonPoints& points(const Transform& transform) const;
+
+private:
+	PolygonPoints m_local;
+	mutable PolygonPoints m_points;
+	mutable uint64_t m_version;
+};
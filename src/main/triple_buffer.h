@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free hand-over of the latest value from one writer thread to one
+// reader thread. The writer fills back() and publishes it; the reader calls
+// update() and then reads front(), which stays untouched until its next update.
+template <typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() :
+		m_middle(1),
+		m_back(0),
+		m_front(2)
+	{
+
+	}
+
+	T& back() { return m_slots[m_back]; }
+
+	void publish()
+	{
+		m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	bool update()
+	{
+		if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0)
+		{
+			return false;
+		}
+
+		m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+
+	const T& front() const { return m_slots[m_front]; }
+
+private:
+	static const uint32_t INDEX = 0x3;
+	static const uint32_t FRESH = 0x4;
+
+	T m_slots[3];
+	std::atomic<uint32_t> m_middle;
+	uint32_t m_back;
+	uint32_t m_front;
+};
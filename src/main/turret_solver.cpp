@@ -0,0 +1,173 @@
+#include "turret_solver.h"
+#include "simd.h"
+
+#define ZERO 0.000001
+
+using namespace std;
+using namespace cv;
+
+TurretSolver::TurretSolver(const float projectileSpeed, const bool lead) :
+	m_size(0),
+	m_projectileSpeed(projectileSpeed),
+	m_lead(lead)
+{
+
+}
+
+void TurretSolver::setProjectileSpeed(const float speed)
+{
+	m_projectileSpeed = speed;
+}
+
+float TurretSolver::projectileSpeed() const
+{
+	return m_projectileSpeed;
+}
+
+void TurretSolver::setLead(const bool lead)
+{
+	m_lead = lead;
+}
+
+bool TurretSolver::lead() const
+{
+	return m_lead;
+}
+
+size_t TurretSolver::add(WarRobot& turret, const cv::Point2f target, const cv::Point2f targetVelocity)
+{
+	size_t index = m_size;
+	resize(m_size + 1);
+
+	turret.mountCombatModule();
+	auto& combatModule = turret.combatModule();
+	auto center = turret.turretCenter();
+
+	Point2f muzzle;
+	Point2f direction;
+	turret.muzzle(muzzle, direction);
+
+	m_originX[index] = center.x;
+	m_originY[index] = center.y;
+	m_angle[index] = turret.angle() + combatModule.angle();
+	m_reach[index] = hypotf(muzzle.x - center.x, muzzle.y - center.y);
+	m_targetX[index] = target.x;
+	m_targetY[index] = target.y;
+	m_velocityX[index] = targetVelocity.x;
+	m_velocityY[index] = targetVelocity.y;
+	m_limitClockwise[index] = combatModule.calculateAngularDisplacement(Rotation::CLOCKWISE);
+	m_limitCounterClockwise[index] = combatModule.calculateAngularDisplacement(Rotation::COUNTER_CLOCKWISE);
+
+	return index;
+}
+
+void TurretSolver::clear()
+{
+	m_size = 0;
+}
+
+size_t TurretSolver::size() const
+{
+	return m_size;
+}
+
+void TurretSolver::solve()
+{
+	const simd::Lane zero = simd::set(0.0f);
+	const simd::Lane epsilon = simd::set(static_cast<float>(ZERO));
+	const simd::Lane speed = simd::set(m_projectileSpeed);
+	const simd::Lane turn = simd::set(static_cast<float>(2.0 * M_PI));
+	const simd::Lane inverseTurn = simd::set(static_cast<float>(0.5 / M_PI));
+	const simd::Lane lead = simd::set(m_lead == true ? 1.0f : 0.0f);
+
+	for (size_t index = 0; index < m_size; index += simd::LANES)
+	{
+		simd::Lane reach = simd::load(&m_reach[index]);
+		simd::Lane dx = simd::sub(simd::load(&m_targetX[index]), simd::load(&m_originX[index]));
+		simd::Lane dy = simd::sub(simd::load(&m_targetY[index]), simd::load(&m_originY[index]));
+		simd::Lane vx = simd::mul(simd::load(&m_velocityX[index]), lead);
+		simd::Lane vy = simd::mul(simd::load(&m_velocityY[index]), lead);
+
+		// |d + v t| = reach + speed t
+		simd::Lane a = simd::sub(simd::add(simd::mul(vx, vx), simd::mul(vy, vy)), simd::mul(speed, speed));
+		simd::Lane b = simd::mul(simd::set(2.0f), simd::sub(simd::add(simd::mul(dx, vx), simd::mul(dy, vy)), simd::mul(reach, speed)));
+		simd::Lane c = simd::sub(simd::add(simd::mul(dx, dx), simd::mul(dy, dy)), simd::mul(reach, reach));
+
+		simd::Lane discriminant = simd::sub(simd::mul(b, b), simd::mul(simd::set(4.0f), simd::mul(a, c)));
+		simd::Lane root = simd::sqrt(simd::max(discriminant, zero));
+		simd::Mask quadratic = simd::greater(simd::abs(a), epsilon);
+		simd::Lane denominator = simd::select(quadratic, simd::mul(simd::set(2.0f), a), simd::set(1.0f));
+
+		simd::Lane first = simd::div(simd::sub(simd::sub(zero, b), root), denominator);
+		simd::Lane second = simd::div(simd::add(simd::sub(zero, b), root), denominator);
+		simd::Lane low = simd::min(first, second);
+		simd::Lane high = simd::max(first, second);
+		simd::Lane time = simd::select(simd::greater(low, zero), low, high);
+
+		simd::Lane linear = simd::div(simd::sub(zero, c), simd::select(simd::greater(simd::abs(b), epsilon), b, simd::set(-1.0f)));
+		time = simd::select(quadratic, time, linear);
+		simd::Mask valid = simd::both(simd::greaterEqual(discriminant, zero), simd::greater(time, zero));
+		time = simd::select(valid, time, zero);
+
+		simd::Lane aimX = simd::add(dx, simd::mul(vx, time));
+		simd::Lane aimY = simd::add(dy, simd::mul(vy, time));
+		simd::Lane bearing = simd::atan2(aimY, aimX);
+
+		simd::Lane delta = simd::sub(bearing, simd::load(&m_angle[index]));
+		delta = simd::sub(delta, simd::mul(turn, simd::nearest(simd::mul(delta, inverseTurn))));
+
+		simd::Lane step = simd::min(delta, simd::load(&m_limitCounterClockwise[index]));
+		step = simd::max(step, simd::sub(zero, simd::load(&m_limitClockwise[index])));
+
+		simd::store(&m_bearing[index], bearing);
+		simd::store(&m_delta[index], delta);
+		simd::store(&m_step[index], step);
+		simd::store(&m_time[index], time);
+	}
+}
+
+AimSolution TurretSolver::solution(size_t index) const
+{
+	AimSolution solution =
+	{
+		m_bearing.at(index),
+		m_delta.at(index),
+		m_step.at(index),
+		m_time.at(index)
+	};
+
+	return solution;
+}
+
+int32_t TurretSolver::apply(size_t index, WarRobot& turret) const
+{
+	if (index >= m_size)
+	{
+		return -1;
+	}
+
+	auto& combatModule = turret.combatModule();
+	combatModule.setAngle(combatModule.angle() + m_step[index]);
+
+	if (fabs(m_step[index] - m_delta[index]) > ZERO)
+	{
+		return -2;
+	}
+
+	return 0;
+}
+
+void TurretSolver::resize(size_t size)
+{
+	size_t capacity = (size + simd::LANES - 1) / simd::LANES * simd::LANES;
+
+	for (auto array : {
+		&m_originX, &m_originY, &m_angle, &m_reach, &m_targetX, &m_targetY, &m_velocityX,
+		&m_velocityY, &m_limitClockwise, &m_limitCounterClockwise, &m_bearing, &m_delta,
+		&m_step, &m_time })
+	{
+		array->resize(capacity, 0.0f);
+	}
+
+	m_size = size;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+#include "war_robot.h"
+
+struct AimSolution
+{
+	float bearing;
+	float delta;
+	float step;
+	float time;
+};
+
+// Batched auto-aim for turret/target pairs. add() gathers the turret pose
+// and its clockwise and counter-clockwise limits from
+// CombatModule::calculateAngularDisplacement; solve() then computes, lane by
+// lane, the lead-corrected bearing, the shortest signed rotation towards it
+// and the step the turret may take this tick. The intercept time accounts
+// for the distance from the turret center to the muzzle; targets that cannot
+// be intercepted, or pairs with lead disabled, are aimed at directly.
+class TurretSolver
+{
+public:
+	TurretSolver(const float projectileSpeed = 600.0f, const bool lead = true);
+	~TurretSolver() = default;
+
+	void setProjectileSpeed(const float speed);
+	float projectileSpeed() const;
+
+	void setLead(const bool lead);
+	bool lead() const;
+
+	size_t add(WarRobot& turret, const cv::Point2f target, const cv::Point2f targetVelocity = cv::Point2f(0, 0));
+	void clear();
+	size_t size() const;
+
+	void solve();
+
+	AimSolution solution(size_t index) const;
+	int32_t apply(size_t index, WarRobot& turret) const;
+
+private:
+	void resize(size_t size);
+
+	size_t m_size;
+	float m_projectileSpeed;
+	bool m_lead;
+
+	std::vector<float> m_originX;
+	std::vector<float> m_originY;
+	std::vector<float> m_angle;
+	std::vector<float> m_reach;
+	std::vector<float> m_targetX;
+	std::vector<float> m_targetY;
+	std::vector<float> m_velocityX;
+	std::vector<float> m_velocityY;
+	std::vector<float> m_limitClockwise;
+	std::vector<float> m_limitCounterClockwise;
+
+	std::vector<float> m_bearing;
+	std::vector<float> m_delta;
+	std::vector<float> m_step;
+	std::vector<float> m_time;
+};
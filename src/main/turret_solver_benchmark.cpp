@@ -0,0 +1,22 @@
+#include "benchmark.h"
+#include "turret_solver.h"
+
+using namespace std;
+using namespace cv;
+
+void benchmarkTurretSolver(Benchmark& benchmark)
+{
+	auto& robots = benchmark.robots();
+
+	TurretSolver solver;
+	for (size_t index = 0; index < robots.size(); index++)
+	{
+		solver.add(robots[index], robots[(index + 1) % robots.size()].center(), Point2f(20.0f, -10.0f));
+	}
+
+	benchmark.measure("TurretSolver::solve", 1, [&solver](size_t)
+	{
+		solver.solve();
+		return solver.solution(0).step;
+	}, solver.size());
+}
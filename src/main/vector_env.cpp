@@ -0,0 +1,244 @@
+#include "vector_env.h"
+#include "opencv2/imgproc.hpp"
+
+#include <cstring>
+#include <random>
+
+using namespace std;
+using namespace cv;
+
+namespace
+{
+	const char actionKeys[ROBOT_ENV_ACTION_COUNT] = { 0, 'w', 's', 'a', 'd', 'q', 'e', 'z', 'x', '.', ',', ']', '[' };
+}
+
+VectorEnv::VectorEnv(
+	const uint32_t environments,
+	const uint32_t robots,
+	const cv::Size2i area,
+	const cv::Size2i render,
+	const uint32_t threads,
+	const uint32_t seed
+) :
+	m_environments(environments),
+	m_robots(robots),
+	m_area(area),
+	m_render(render),
+	m_seed(seed),
+	m_executor(threads),
+	m_episodes(environments, 0),
+	m_observations(nullptr),
+	m_renders(nullptr),
+	m_actions(nullptr)
+{
+	Border border =
+	{
+		static_cast<float>(m_area.width) - 1.0f,
+		static_cast<float>(m_area.height) - 1.0f,
+		0.0f,
+		0.0f
+	};
+
+	for (uint32_t environment = 0; environment < m_environments; environment++)
+	{
+		unique_ptr<ArenaWorld> world(new ArenaWorld(border));
+
+		for (uint32_t index = 0; index < m_robots; index++)
+		{
+			auto robot = WarRobot(60, 120, { 10, 40 });
+			robot.setSpeed(SPEED);
+			robot.setAngularSpeed(ANGULAR_SPEED);
+			robot.combatModule().setAngularSpeed(0.2f);
+			world->add(robot);
+		}
+
+		world->setController([this, environment](ArenaWorld&, size_t index)
+		{
+			uint8_t action = m_actions[static_cast<size_t>(environment) * m_robots + index];
+			return action < ROBOT_ENV_ACTION_COUNT ? actionKeys[action] : 0;
+		});
+		world->setObserver([this, environment](ArenaWorld& world)
+		{
+			observe(world, environment);
+		});
+
+		m_executor.add(std::move(world));
+	}
+}
+
+uint32_t VectorEnv::environments() const
+{
+	return m_environments;
+}
+
+uint32_t VectorEnv::robots() const
+{
+	return m_robots;
+}
+
+cv::Size2i VectorEnv::area() const
+{
+	return m_area;
+}
+
+cv::Size2i VectorEnv::renderSize() const
+{
+	return m_render;
+}
+
+size_t VectorEnv::observationBytes() const
+{
+	return static_cast<size_t>(m_environments) * m_robots * ROBOT_ENV_OBSERVATION_SIZE * sizeof(float);
+}
+
+size_t VectorEnv::renderBytes() const
+{
+	return static_cast<size_t>(m_environments) * m_render.width * m_render.height;
+}
+
+int32_t VectorEnv::bind(float* observations, uint8_t* renders)
+{
+	if (observations == nullptr)
+	{
+		return -1;
+	}
+
+	m_observations = observations;
+	m_renders = renders;
+
+	return 0;
+}
+
+int32_t VectorEnv::reset(const uint8_t* mask)
+{
+	if (m_observations == nullptr)
+	{
+		return -1;
+	}
+
+	for (uint32_t environment = 0; environment < m_environments; environment++)
+	{
+		if (mask == nullptr || mask[environment] != 0)
+		{
+			auto& world = m_executor.world(environment);
+			place(world, environment);
+			observe(world, environment);
+		}
+	}
+
+	return 0;
+}
+
+int32_t VectorEnv::step(const uint8_t* actions)
+{
+	if (m_observations == nullptr || actions == nullptr)
+	{
+		return -1;
+	}
+
+	m_actions = actions;
+	int32_t result = m_executor.run(1);
+	m_actions = nullptr;
+
+	return result;
+}
+
+ArenaWorld& VectorEnv::world(size_t index)
+{
+	return m_executor.world(index);
+}
+
+void VectorEnv::place(ArenaWorld& world, const uint32_t environment)
+{
+	mt19937 random(m_seed * 2654435761u + environment * 40503u + m_episodes[environment]++ * 97u);
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	for (size_t index = 0; index < world.size(); index++)
+	{
+		auto& robot = world.robot(index);
+
+		float gunReach = 1.5f * robot.combatModule().length();
+		float radius = max(hypotf(robot.length() / 2.0f, (robot.width() + 3.0f * robot.wheel().width) / 2.0f), gunReach);
+		float width = max(static_cast<float>(m_area.width) - 1.0f - 2.0f * radius, 0.0f);
+		float height = max(static_cast<float>(m_area.height) - 1.0f - 2.0f * radius, 0.0f);
+
+		// A crowded environment keeps the last attempt rather than failing.
+		for (uint32_t attempt = 0; attempt < PLACEMENT_ATTEMPTS; attempt++)
+		{
+			robot.setAngle(static_cast<float>(2.0 * M_PI) * unit(random));
+			robot.combatModule().setAngle(static_cast<float>(2.0 * M_PI) * unit(random));
+			robot.setCenter(radius + width * unit(random), radius + height * unit(random));
+
+			auto footprint = robot.footprint();
+			bool free = true;
+			for (size_t other = 0; other < index && free == true; other++)
+			{
+				free = Arena::overlaps(footprint, world.robot(other).footprint()) == false;
+			}
+
+			if (free == true)
+			{
+				break;
+			}
+		}
+	}
+
+	world.arena().update();
+}
+
+void VectorEnv::observe(ArenaWorld& world, const uint32_t environment)
+{
+	float* observation = m_observations + static_cast<size_t>(environment) * m_robots * ROBOT_ENV_OBSERVATION_SIZE;
+	auto border = world.border();
+
+	Mat image;
+	float scaleX = 0.0f;
+	float scaleY = 0.0f;
+	if (m_renders != nullptr && m_render.area() > 0)
+	{
+		auto pixels = m_renders + static_cast<size_t>(environment) * m_render.width * m_render.height;
+		memset(pixels, 0, static_cast<size_t>(m_render.width) * m_render.height);
+		image = Mat(m_render.height, m_render.width, CV_8UC1, pixels);
+		scaleX = static_cast<float>(m_render.width) / m_area.width;
+		scaleY = static_cast<float>(m_render.height) / m_area.height;
+	}
+
+	for (size_t index = 0; index < world.size(); index++)
+	{
+		auto& robot = world.robot(index);
+		auto footprint = robot.footprint();
+		float clearance[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+
+		for (size_t part = 0; part < footprint.size; part++)
+		{
+			auto& points = footprint.parts[part];
+			Point vertices[POLYGON_CAPACITY];
+
+			for (size_t vertex = 0; vertex < points.size(); vertex++)
+			{
+				auto& point = points[vertex];
+				clearance[0] = min(clearance[0], border.right - point.x);
+				clearance[1] = min(clearance[1], border.top - point.y);
+				clearance[2] = min(clearance[2], point.x - border.left);
+				clearance[3] = min(clearance[3], point.y - border.bottom);
+				vertices[vertex] = Point(cvRound(point.x * scaleX), cvRound((static_cast<float>(m_area.height) - 1.0f - point.y) * scaleY));
+			}
+
+			if (image.empty() == false && points.empty() == false)
+			{
+				fillConvexPoly(image, vertices, static_cast<int>(points.size()), Scalar(0xFF));
+			}
+		}
+
+		auto center = robot.center();
+		observation[0] = center.x;
+		observation[1] = center.y;
+		observation[2] = robot.angle();
+		observation[3] = robot.combatModule().angle();
+		observation[4] = clearance[0];
+		observation[5] = clearance[1];
+		observation[6] = clearance[2];
+		observation[7] = clearance[3];
+		observation += ROBOT_ENV_OBSERVATION_SIZE;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+
+#include "arena_executor.h"
+#include "robot_env.h"
+
+#define PLACEMENT_ATTEMPTS 64
+
+// A batch of independent environments of the same robot count stepped
+// together on an ArenaExecutor. Actions are read and observations written in
+// place through caller-owned buffers bound once, so a step neither copies nor
+// allocates. reset() places the robots of the masked environments at seeded
+// random poses that do not overlap.
+class VectorEnv
+{
+public:
+	VectorEnv(
+		const uint32_t environments,
+		const uint32_t robots,
+		const cv::Size2i area = cv::Size2i(1080, 720),
+		const cv::Size2i render = cv::Size2i(0, 0),
+		const uint32_t threads = 0,
+		const uint32_t seed = 1
+	);
+	~VectorEnv() = default;
+
+	VectorEnv(const VectorEnv&) = delete;
+	VectorEnv& operator=(const VectorEnv&) = delete;
+
+	uint32_t environments() const;
+	uint32_t robots() const;
+	cv::Size2i area() const;
+	cv::Size2i renderSize() const;
+	size_t observationBytes() const;
+	size_t renderBytes() const;
+
+	int32_t bind(float* observations, uint8_t* renders = nullptr);
+	int32_t reset(const uint8_t* mask = nullptr);
+	int32_t step(const uint8_t* actions);
+
+	ArenaWorld& world(size_t index);
+
+private:
+	void place(ArenaWorld& world, const uint32_t environment);
+	void observe(ArenaWorld& world, const uint32_t environment);
+
+	uint32_t m_environments;
+	uint32_t m_robots;
+	cv::Size2i m_area;
+	cv::Size2i m_render;
+	uint32_t m_seed;
+	ArenaExecutor m_executor;
+	std::vector<uint32_t> m_episodes;
+	float* m_observations;
+	uint8_t* m_renders;
+	const uint8_t* m_actions;
+};
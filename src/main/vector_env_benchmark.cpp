@@ -0,0 +1,25 @@
+#include "benchmark.h"
+#include "vector_env.h"
+
+using namespace std;
+using namespace cv;
+
+void benchmarkVectorEnv(Benchmark& benchmark)
+{
+	VectorEnv environments(256, 4, benchmark.area(), Size2i(64, 48), 0, benchmark.seed() + static_cast<uint32_t>(benchmark.placement()));
+	vector<float> observations(environments.observationBytes() / sizeof(float));
+	vector<uint8_t> renders(environments.renderBytes());
+	vector<uint8_t> actions(environments.environments() * environments.robots());
+	environments.bind(observations.data(), renders.data());
+	environments.reset();
+
+	benchmark.measure("VectorEnv::step", 1, [&environments, &observations, &actions](size_t)
+	{
+		for (size_t index = 0; index < actions.size(); index++)
+		{
+			actions[index] = static_cast<uint8_t>((actions[index] + index) % ROBOT_ENV_ACTION_COUNT);
+		}
+		environments.step(actions.data());
+		return observations[0];
+	}, actions.size());
+}
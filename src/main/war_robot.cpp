@@ -1,5 +1,4 @@
 #include "war_robot.h"
-#include "opencv2/imgproc.hpp"
 
 using namespace cv;
 using namespace std;
@@ -15,7 +14,9 @@ WarRobot::WarRobot(
 	const float angularSpeed
 ) : 
 	Robot(width, length, wheel, center, angle, speed, angularSpeed),
-	m_combatModule(combatModule)
+	m_combatModule(combatModule),
+	m_tower(combatModule.towerShape()),
+	m_gun(combatModule.gunShape())
 {
 	
 }
@@ -25,121 +26,89 @@ CombatModule& WarRobot::combatModule(void)
 	return m_combatModule;
 }
 
-int32_t WarRobot::draw(cv::Mat& image)
+const CombatModule& WarRobot::combatModule(void) const
 {
-	if (image.empty() == true)
-	{
-		return -1;
-	}
+	return m_combatModule;
+}
 
-	if (image.cols != area().width || image.rows != area().height)
-	{
-		return -2;
-	}
+PolygonPoints WarRobot::boundaryPoints()
+{
+	PolygonPoints points = Robot::boundaryPoints();
 
-	auto point = [this](const Point2f poligonCenter, const float x, const float y)
-	{
-		auto point = cv::Point2f();
-		point.x = center().x + (x + poligonCenter.x) * cosf(angle()) - (y + poligonCenter.y) * sinf(angle());
-		point.y = center().y + (x + poligonCenter.x) * sinf(angle()) + (y + poligonCenter.y) * cosf(angle());
+	updateTransforms();
 
-		point.y = static_cast<float>(area().height) - 1.0f - point.y;
-		return point;
-	};
+	auto& gunPoints = m_gun.points(m_gunTransform);
+	points.append(gunPoints.begin(), gunPoints.end());
 
-	auto poligon = [](cv::Mat& image, vector<Point2f>& poligon, const Scalar& color)
-	{
-		line(image, poligon.front(), poligon.back(), color);
-		for (int32_t index = 1; index < poligon.size(); index++)
-		{
-			line(image, poligon.at(index - 1), poligon.at(index), color);
-		}
-	};
+	return points;
+}
 
-	auto black = Scalar(0x00, 0x00, 0x00);
+Footprint WarRobot::footprint()
+{
+	Footprint footprint = Robot::footprint();
 
-	vector<Point2f> hull =
-	{
-		point(Point2f(),  length() / 2.0f,  width() / 2.0f),
-		point(Point2f(), -length() / 2.0f,  width() / 2.0f),
-		point(Point2f(), -length() / 2.0f, -width() / 2.0f),
-		point(Point2f(),  length() / 2.0f, -width() / 2.0f)
-	};
+	updateTransforms();
 
-	poligon(image, hull, black);
+	footprint.parts[footprint.size++] = m_tower.points(m_turretTransform);
+	footprint.parts[footprint.size++] = m_gun.points(m_gunTransform);
 
-	vector<Point2f> wheelCenter =
-	{
-		Point2f( (length() - wheel().diameter) / 2.0f,  (width() / 2.0f + wheel().width)),
-		Point2f(-(length() - wheel().diameter) / 2.0f,  (width() / 2.0f + wheel().width)),
-		Point2f(-(length() - wheel().diameter) / 2.0f, -(width() / 2.0f + wheel().width)),
-		Point2f( (length() - wheel().diameter) / 2.0f, -(width() / 2.0f + wheel().width))
-	};
+	return footprint;
+}
 
-	for (auto currentWheelCenter : wheelCenter)
-	{
-		vector<Point2f> currentWheel =
-		{
-			point(currentWheelCenter, -wheel().diameter / 2.0f,  wheel().width / 2.0f),
-			point(currentWheelCenter, -wheel().diameter / 2.0f, -wheel().width / 2.0f),
-			point(currentWheelCenter,  wheel().diameter / 2.0f, -wheel().width / 2.0f),
-			point(currentWheelCenter,  wheel().diameter / 2.0f,  wheel().width / 2.0f)
-		};
-
-		poligon(image, currentWheel, black);
-	}
+Outline WarRobot::outline()
+{
+	Outline outline = Robot::outline();
 
-	auto towerPoints = m_combatModule.towerPoints();
+	updateTransforms();
 
-	vector<Point2f> tower;
-	for (auto currentPoint : towerPoints)
-	{
-		tower.push_back(point(combatModule().center(), currentPoint.x, currentPoint.y));
-	}
+	outline.parts[outline.size++] = m_tower.points(m_turretTransform);
+	outline.parts[outline.size++] = m_gun.points(m_gunTransform);
 
-	poligon(image, tower, black);
+	return outline;
+}
 
-	auto gunPoints = m_combatModule.gunPoints();
+void WarRobot::muzzle(cv::Point2f& origin, cv::Point2f& direction)
+{
+	updateTransforms();
 
-	vector<Point2f> gun;
-	for (auto currentPoint : gunPoints)
-	{
-		gun.push_back(point(combatModule().center(), currentPoint.x, currentPoint.y));
-	}
+	auto& gunPoints = m_gun.points(m_gunTransform);
+	origin = (gunPoints[0] + gunPoints[3]) * 0.5f;
 
-	poligon(image, gun, black);
+	auto axis = gunPoints[0] - gunPoints[1];
+	direction = axis * (1.0f / hypotf(axis.x, axis.y));
+}
 
-	return 0;
+cv::Point2f WarRobot::turretCenter()
+{
+	updateTransforms();
+	return m_turretTransform.origin();
 }
 
-vector<Point2f> WarRobot::boundaryPoints()
+void WarRobot::updateTransforms()
 {
-	auto point = [this](const float x, const float y)
-	{
-		auto point = cv::Point2f();
-		point.x = center().x + x * cosf(angle()) - y * sinf(angle());
-		point.y = center().y + x * sinf(angle()) + y * cosf(angle());
+	m_turretTransform.setTranslation(m_combatModule.center());
+	m_turretTransform.setAngle(m_combatModule.angle());
+	m_gunTransform.setTranslation(Point2f(m_combatModule.length(), 0.0f));
 
-		return point;
-	};
+	m_turretTransform.update(&transform());
+	m_gunTransform.update(&m_turretTransform);
+}
 
-	vector<Point2f> points =
-	{
-		point( length() / 2.0f,  (width() + 3.0f * wheel().width) / 2.0f),
-		point(-length() / 2.0f,  (width() + 3.0f * wheel().width) / 2.0f),
-		point(-length() / 2.0f, -(width() + 3.0f * wheel().width) / 2.0f),
-		point( length() / 2.0f, -(width() + 3.0f * wheel().width) / 2.0f),
-	};
+const Transform& WarRobot::turretTransform() const
+{
+	return m_turretTransform;
+}
 
-	auto gunPoints = m_combatModule.gunPoints();
-	for (auto& currentPoint : gunPoints)
-	{
-		currentPoint = point(combatModule().center().x + currentPoint.x, 
-			                 combatModule().center().y + currentPoint.y);
-	}
-	points.insert(points.end(), gunPoints.begin(), gunPoints.end());
+const Transform& WarRobot::gunTransform() const
+{
+	return m_gunTransform;
+}
+
+void WarRobot::mountCombatModule()
+{
+	updateTransforms();
 
-	auto towerPoint = point(combatModule().center().x, combatModule().center().y);
+	auto towerPoint = m_turretTransform.origin();
 	Border border =
 	{
 		-(towerPoint.y - this->border().top   ),
@@ -148,9 +117,7 @@ vector<Point2f> WarRobot::boundaryPoints()
 		 (towerPoint.x - this->border().right )
 	};
 	m_combatModule.setBorder(border);
-	m_combatModule.rotateBoundaryPoints(angle() - M_PI_2);
-
-	return points;
+	m_combatModule.setMountAngle(angle() - M_PI_2);
 }
 
 void WarRobot::doSomething(const char key)
@@ -200,12 +167,14 @@ void WarRobot::doSomething(const char key)
 	case ']':
 	case '}':
 	{
-		combatModule().rotate(Rotation::CLOCKWISE);
+		mountCombatModule();
+		m_combatModule.rotate(Rotation::CLOCKWISE);
 		break;
 	}
 	case '[':
 	case '{':
-		combatModule().rotate(Rotation::COUNTER_CLOCKWISE);
+		mountCombatModule();
+		m_combatModule.rotate(Rotation::COUNTER_CLOCKWISE);
 		break;
 	default:
 		break;
@@ -19,13 +19,30 @@ public:
 	~WarRobot() = default;
 
 	CombatModule& combatModule();
+	const CombatModule& combatModule() const;
 
-	int32_t draw(cv::Mat& image);
+	// Refreshes the combat module's Border and mount angle from the current
+	// chassis pose; needed before rotating the turret after the chassis moved.
+	void mountCombatModule();
 
 	void doSomething(const char key);
 
-	std::vector<cv::Point2f> boundaryPoints();
+	PolygonPoints boundaryPoints();
+	Footprint footprint();
+	Outline outline();
+
+	void muzzle(cv::Point2f& origin, cv::Point2f& direction);
+	cv::Point2f turretCenter();
+
+protected:
+	void updateTransforms();
+	const Transform& turretTransform() const;
+	const Transform& gunTransform() const;
 
 private:
 	CombatModule m_combatModule;
+	Transform m_turretTransform;
+	Transform m_gunTransform;
+	CachedPolygon m_tower;
+	CachedPolygon m_gun;
 };
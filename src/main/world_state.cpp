@@ -0,0 +1,312 @@
+#include "world_state.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define COMBAT_MODULE_FLAG 0x1
+
+using namespace std;
+using namespace cv;
+
+namespace
+{
+	const char MAGIC[4] = { 'W', 'R', 'W', 'S' };
+}
+
+int32_t WorldState::capture(const std::vector<Robot*>& robots, const uint64_t tick)
+{
+	m_buffer.resize(sizeof(WorldStateHeader) + robots.size() * sizeof(RobotState));
+
+	auto states = records();
+	for (size_t index = 0; index < robots.size(); index++)
+	{
+		if (robots[index] == nullptr)
+		{
+			m_buffer.clear();
+			return -1;
+		}
+		capture(*robots[index], states[index]);
+	}
+
+	auto& state = header();
+	memcpy(state.magic, MAGIC, sizeof(MAGIC));
+	state.version = WORLD_STATE_VERSION;
+	state.count = robots.size();
+	state.tick = tick;
+	state.recordSize = sizeof(RobotState);
+	state.reserved = 0;
+	state.checksum = checksum(states, robots.size());
+
+	return 0;
+}
+
+int32_t WorldState::capture(Arena& arena, const uint64_t tick)
+{
+	vector<Robot*> robots(arena.size());
+	for (size_t index = 0; index < robots.size(); index++)
+	{
+		robots[index] = &arena.robot(index);
+	}
+
+	return capture(robots, tick);
+}
+
+int32_t WorldState::restore(const std::vector<Robot*>& robots) const
+{
+	int32_t result = validate();
+	if (result != 0)
+	{
+		return result;
+	}
+
+	if (header().count != robots.size())
+	{
+		return -1;
+	}
+
+	// A mismatch anywhere leaves every robot untouched.
+	auto states = records();
+	for (size_t index = 0; index < robots.size(); index++)
+	{
+		if (robots[index] == nullptr)
+		{
+			return -1;
+		}
+
+		result = validate(states[index], *robots[index]);
+		if (result != 0)
+		{
+			return result;
+		}
+	}
+
+	for (size_t index = 0; index < robots.size(); index++)
+	{
+		restore(states[index], *robots[index]);
+	}
+
+	return 0;
+}
+
+int32_t WorldState::restore(Arena& arena) const
+{
+	vector<Robot*> robots(arena.size());
+	for (size_t index = 0; index < robots.size(); index++)
+	{
+		robots[index] = &arena.robot(index);
+	}
+
+	int32_t result = restore(robots);
+	arena.update();
+
+	return result;
+}
+
+int32_t WorldState::save(const std::string& path) const
+{
+	if (validate() != 0)
+	{
+		return -1;
+	}
+
+	string temporary = path + ".tmp";
+	{
+		ofstream file(temporary, ios::binary | ios::trunc);
+		if (file.is_open() == false)
+		{
+			return -1;
+		}
+
+		file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+		file.flush();
+		if (file.good() == false)
+		{
+			return -1;
+		}
+	}
+
+#ifdef _WIN32
+	if (MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) == FALSE)
+	{
+		return -1;
+	}
+#else
+	if (rename(temporary.c_str(), path.c_str()) != 0)
+	{
+		return -1;
+	}
+#endif
+
+	return 0;
+}
+
+int32_t WorldState::load(const std::string& path)
+{
+	ifstream file(path, ios::binary | ios::ate);
+	if (file.is_open() == false)
+	{
+		return -1;
+	}
+
+	auto size = static_cast<size_t>(file.tellg());
+	file.seekg(0);
+
+	m_buffer.resize(size);
+	file.read(reinterpret_cast<char*>(m_buffer.data()), size);
+	if (file.good() == false)
+	{
+		m_buffer.clear();
+		return -1;
+	}
+
+	int32_t result = validate();
+	if (result != 0)
+	{
+		m_buffer.clear();
+	}
+
+	return result;
+}
+
+uint64_t WorldState::tick() const
+{
+	return m_buffer.size() < sizeof(WorldStateHeader) ? 0 : header().tick;
+}
+
+size_t WorldState::size() const
+{
+	return m_buffer.size() < sizeof(WorldStateHeader) ? 0 : static_cast<size_t>(header().count);
+}
+
+const std::vector<uint8_t>& WorldState::buffer() const
+{
+	return m_buffer;
+}
+
+WorldStateHeader& WorldState::header()
+{
+	return *reinterpret_cast<WorldStateHeader*>(m_buffer.data());
+}
+
+const WorldStateHeader& WorldState::header() const
+{
+	return *reinterpret_cast<const WorldStateHeader*>(m_buffer.data());
+}
+
+RobotState* WorldState::records()
+{
+	return reinterpret_cast<RobotState*>(m_buffer.data() + sizeof(WorldStateHeader));
+}
+
+const RobotState* WorldState::records() const
+{
+	return reinterpret_cast<const RobotState*>(m_buffer.data() + sizeof(WorldStateHeader));
+}
+
+int32_t WorldState::validate() const
+{
+	if (m_buffer.size() < sizeof(WorldStateHeader))
+	{
+		return -2;
+	}
+
+	auto& state = header();
+	if (memcmp(state.magic, MAGIC, sizeof(MAGIC)) != 0 || state.version != WORLD_STATE_VERSION || state.recordSize != sizeof(RobotState))
+	{
+		return -2;
+	}
+
+	if (m_buffer.size() != sizeof(WorldStateHeader) + state.count * sizeof(RobotState))
+	{
+		return -2;
+	}
+
+	if (state.checksum != checksum(records(), static_cast<size_t>(state.count)))
+	{
+		return -2;
+	}
+
+	return 0;
+}
+
+uint64_t WorldState::checksum(const RobotState* records, const size_t count)
+{
+	static_assert(sizeof(RobotState) % sizeof(uint64_t) == 0, "RobotState must be a whole number of words");
+
+	auto words = reinterpret_cast<const uint64_t*>(records);
+	size_t size = count * sizeof(RobotState) / sizeof(uint64_t);
+
+	uint64_t sum = 0x9E3779B97F4A7C15ull;
+	for (size_t index = 0; index < size; index++)
+	{
+		sum = ((sum << 5) | (sum >> 59)) ^ words[index];
+	}
+
+	return sum;
+}
+
+void WorldState::capture(Robot& robot, RobotState& state)
+{
+	memset(&state, 0, sizeof(state));
+
+	auto center = robot.center();
+	state.centerX = center.x;
+	state.centerY = center.y;
+	state.angle = robot.angle();
+	state.speed = robot.speed();
+	state.angularSpeed = robot.angularSpeed();
+	state.border = robot.border();
+	state.areaWidth = robot.area().width;
+	state.areaHeight = robot.area().height;
+	state.width = robot.width();
+	state.length = robot.length();
+	state.wheel = robot.wheel();
+
+	auto warRobot = dynamic_cast<const WarRobot*>(&robot);
+	if (warRobot != nullptr)
+	{
+		auto& combatModule = warRobot->combatModule();
+		state.turretAngle = combatModule.angle();
+		state.turretAngularSpeed = combatModule.angularSpeed();
+		state.flags |= COMBAT_MODULE_FLAG;
+	}
+}
+
+int32_t WorldState::validate(const RobotState& state, const Robot& robot)
+{
+	auto warRobot = dynamic_cast<const WarRobot*>(&robot);
+	bool combatModule = (state.flags & COMBAT_MODULE_FLAG) != 0;
+
+	if (state.width != robot.width() || state.length != robot.length() ||
+		state.wheel.width != robot.wheel().width || state.wheel.diameter != robot.wheel().diameter ||
+		combatModule != (warRobot != nullptr))
+	{
+		return -2;
+	}
+
+	return 0;
+}
+
+void WorldState::restore(const RobotState& state, Robot& robot)
+{
+	auto warRobot = dynamic_cast<WarRobot*>(&robot);
+
+	robot.setArea(Size2i(state.areaWidth, state.areaHeight));
+	robot.setBorder(state.border);
+	robot.setCenter(state.centerX, state.centerY);
+	robot.setAngle(state.angle);
+	robot.setSpeed(state.speed);
+	robot.setAngularSpeed(state.angularSpeed);
+
+	if (warRobot != nullptr)
+	{
+		auto& combatModule = warRobot->combatModule();
+		combatModule.setAngle(state.turretAngle);
+		combatModule.setAngularSpeed(state.turretAngularSpeed);
+	}
+}
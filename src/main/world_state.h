@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "war_robot.h"
+#include "arena.h"
+
+#define WORLD_STATE_VERSION 1
+
+struct WorldStateHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t count;
+	uint64_t tick;
+	uint32_t recordSize;
+	uint32_t reserved;
+	uint64_t checksum;
+};
+
+struct RobotState
+{
+	float centerX;
+	float centerY;
+	float angle;
+	float speed;
+	float angularSpeed;
+	Border border;
+	int32_t areaWidth;
+	int32_t areaHeight;
+	float width;
+	float length;
+	Wheel wheel;
+	float turretAngle;
+	float turretAngularSpeed;
+	uint32_t flags;
+	uint32_t reserved[2];
+};
+
+// Versioned snapshot of every robot in the world, kept as one contiguous
+// buffer of a header and fixed-size RobotState records that is written and
+// read with a single call. Geometry is stored only to reject snapshots taken
+// from a different world; restore() checks every record before it applies any.
+class WorldState
+{
+public:
+	WorldState() = default;
+	~WorldState() = default;
+
+	int32_t capture(const std::vector<Robot*>& robots, const uint64_t tick = 0);
+	int32_t capture(Arena& arena, const uint64_t tick = 0);
+	int32_t restore(const std::vector<Robot*>& robots) const;
+	int32_t restore(Arena& arena) const;
+
+	int32_t save(const std::string& path) const;
+	int32_t load(const std::string& path);
+
+	uint64_t tick() const;
+	size_t size() const;
+	const std::vector<uint8_t>& buffer() const;
+
+private:
+	WorldStateHeader& header();
+	const WorldStateHeader& header() const;
+	RobotState* records();
+	const RobotState* records() const;
+
+	int32_t validate() const;
+	static uint64_t checksum(const RobotState* records, const size_t count);
+	static void capture(Robot& robot, RobotState& state);
+	static int32_t validate(const RobotState& state, const Robot& robot);
+	static void restore(const RobotState& state, Robot& robot);
+
+	std::vector<uint8_t> m_buffer;
+};